@@ -0,0 +1,119 @@
+#include "concurrenthashtable.h"
+#include "hashtable.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <time.h>
+
+#define NUM_KEYS 1000000
+#define OPS_PER_THREAD 2000000
+#define MAX_THREADS 32
+// Percentage of operations that are lookups
+#define READ_PERCENT 95
+
+typedef struct {
+    bool concurrent;
+    hash_table_t* ht;
+    pthread_mutex_t* lock;
+    concurrent_hash_table_t* cht;
+    char (*names)[24];
+    uint64_t seed;
+} worker_args_t;
+
+static double now_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+// xorshift64* generator, so runs are reproducible
+static uint64_t next_random(uint64_t* state) {
+    *state ^= *state >> 12;
+    *state ^= *state << 25;
+    *state ^= *state >> 27;
+    return *state * 0x2545f4914f6cdd1dULL;
+}
+
+// Mix of lookups with deletes immediately followed by reinsertions, so the
+// number of keys stays constant
+static void* worker(void* ptr) {
+    worker_args_t* args = ptr;
+    uint64_t state = args->seed;
+    for (size_t i = 0; i < OPS_PER_THREAD; i++) {
+        uint64_t r = next_random(&state);
+        const char* key = args->names[(r >> 8) % NUM_KEYS];
+        bool read = r % 100 < READ_PERCENT;
+        if (args->concurrent) {
+            if (read) {
+                concurrent_hash_table_lookup(args->cht, key);
+            } else {
+                void* obj = concurrent_hash_table_delete(args->cht, key);
+                if (obj != NULL) {
+                    concurrent_hash_table_insert(args->cht, key, obj);
+                }
+            }
+        } else {
+            pthread_mutex_lock(args->lock);
+            if (read) {
+                hash_table_lookup(args->ht, key);
+            } else {
+                void* obj = hash_table_delete(args->ht, key);
+                if (obj != NULL) {
+                    hash_table_insert(args->ht, key, obj);
+                }
+            }
+            pthread_mutex_unlock(args->lock);
+        }
+    }
+    return NULL;
+}
+
+static double run(worker_args_t* base, size_t num_threads) {
+    pthread_t threads[MAX_THREADS];
+    worker_args_t args[MAX_THREADS];
+    double start = now_ns();
+    for (size_t t = 0; t < num_threads; t++) {
+        args[t] = *base;
+        args[t].seed = 0x9e3779b97f4a7c15ULL * (t + 1);
+        pthread_create(&threads[t], NULL, worker, &args[t]);
+    }
+    for (size_t t = 0; t < num_threads; t++) {
+        pthread_join(threads[t], NULL);
+    }
+    double elapsed = now_ns() - start;
+    // Millions of operations per second
+    return num_threads * OPS_PER_THREAD / elapsed * 1e3;
+}
+
+int main(int argc, char** argv) {
+    size_t max_threads = argc > 1 ? strtoul(argv[1], NULL, 10) : 8;
+    if (max_threads > MAX_THREADS) {
+        max_threads = MAX_THREADS;
+    }
+    printf("Running benchmark: %s (%zu keys, %d%% reads)\n", argv[0],
+           (size_t)NUM_KEYS, READ_PERCENT);
+
+    char(*names)[24] = malloc(NUM_KEYS * sizeof(*names));
+    hash_table_t* ht = hash_table_create(16, NULL);
+    concurrent_hash_table_t* cht = concurrent_hash_table_create(16, NULL);
+    for (size_t i = 0; i < NUM_KEYS; i++) {
+        snprintf(names[i], sizeof(names[i]), "key-%zu", i);
+        hash_table_insert(ht, names[i], (void*)(i + 1));
+        concurrent_hash_table_insert(cht, names[i], (void*)(i + 1));
+    }
+    pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+
+    for (size_t n = 1; n <= max_threads; n *= 2) {
+        worker_args_t args = {false, ht, &lock, cht, names, 0};
+        double mutex = run(&args, n);
+        args.concurrent = true;
+        double concurrent = run(&args, n);
+        printf("threads_%zu\tglobal_mutex\t%.2f Mops/s\n", n, mutex);
+        printf("threads_%zu\tconcurrent\t%.2f Mops/s\t(%.2fx)\n", n,
+               concurrent, concurrent / mutex);
+    }
+
+    concurrent_hash_table_destroy(cht);
+    hash_table_destroy(ht);
+    free(names);
+    return 0;
+}
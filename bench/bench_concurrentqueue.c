@@ -0,0 +1,176 @@
+#include "concurrentqueue.h"
+#include "linkedlist.h"
+#include "spscring.h"
+#include <pthread.h>
+#include <sched.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+
+#define OPS_PER_THREAD 200000
+#define MAX_THREADS 32
+// Number of objects passed from producer to consumer in the SPSC benchmark
+#define PIPELINE_ITEMS 4000000
+#define RING_CAPACITY 1024
+
+typedef enum { QUEUE_MUTEX_LIST, QUEUE_LOCK_FREE } queue_kind_t;
+
+typedef struct {
+    queue_kind_t kind;
+    linked_list_t* ll;
+    pthread_mutex_t* lock;
+    concurrent_queue_t* q;
+    // Latency of every enqueue, in nanoseconds
+    uint32_t* latencies;
+} worker_args_t;
+
+static double now_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static void push(worker_args_t* args, void* obj) {
+    if (args->kind == QUEUE_LOCK_FREE) {
+        concurrent_queue_push_back(args->q, obj);
+    } else {
+        pthread_mutex_lock(args->lock);
+        linked_list_push_back(args->ll, obj);
+        pthread_mutex_unlock(args->lock);
+    }
+}
+
+static void* pop(worker_args_t* args) {
+    if (args->kind == QUEUE_LOCK_FREE) {
+        return concurrent_queue_pop_front(args->q);
+    }
+    pthread_mutex_lock(args->lock);
+    void* obj = linked_list_pop_front(args->ll);
+    pthread_mutex_unlock(args->lock);
+    return obj;
+}
+
+// Every thread alternates enqueues and dequeues, so the queue stays short and
+// all threads contend on both ends
+static void* worker(void* ptr) {
+    worker_args_t* args = ptr;
+    for (size_t i = 0; i < OPS_PER_THREAD; i++) {
+        double start = now_ns();
+        push(args, (void*)(i + 1));
+        args->latencies[i] = (uint32_t)(now_ns() - start);
+        pop(args);
+    }
+    return NULL;
+}
+
+static int compare_latency(const void* a, const void* b) {
+    uint32_t x = *(const uint32_t*)a;
+    uint32_t y = *(const uint32_t*)b;
+    return (x > y) - (x < y);
+}
+
+// Runs the workload on `num_threads` threads, returning millions of
+// operations per second and storing the 99th percentile enqueue latency
+static double run(worker_args_t* base, size_t num_threads, uint32_t* latencies,
+                  double* p99) {
+    pthread_t threads[MAX_THREADS];
+    worker_args_t args[MAX_THREADS];
+    double start = now_ns();
+    for (size_t t = 0; t < num_threads; t++) {
+        args[t] = *base;
+        args[t].latencies = latencies + t * OPS_PER_THREAD;
+        pthread_create(&threads[t], NULL, worker, &args[t]);
+    }
+    for (size_t t = 0; t < num_threads; t++) {
+        pthread_join(threads[t], NULL);
+    }
+    double elapsed = now_ns() - start;
+
+    size_t count = num_threads * OPS_PER_THREAD;
+    qsort(latencies, count, sizeof(*latencies), compare_latency);
+    *p99 = latencies[count * 99 / 100];
+    return 2.0 * count / elapsed * 1e3;
+}
+
+static void* ring_producer(void* ptr) {
+    spsc_ring_t* ring = ptr;
+    for (size_t i = 1; i <= PIPELINE_ITEMS; i++) {
+        while (!spsc_ring_push(ring, (void*)i)) {
+            sched_yield();
+        }
+    }
+    return NULL;
+}
+
+static void* queue_producer(void* ptr) {
+    worker_args_t* args = ptr;
+    for (size_t i = 1; i <= PIPELINE_ITEMS; i++) {
+        push(args, (void*)i);
+    }
+    return NULL;
+}
+
+// One producer and one consumer passing PIPELINE_ITEMS objects through each
+// queue type, in millions of objects per second
+static void bench_pipeline(worker_args_t* base) {
+    const char* names[] = {"mutex_list", "lock_free", "spsc_ring"};
+    for (size_t k = 0; k < 3; k++) {
+        worker_args_t args = *base;
+        args.kind = k == 0 ? QUEUE_MUTEX_LIST : QUEUE_LOCK_FREE;
+        spsc_ring_t* ring = spsc_ring_create(RING_CAPACITY);
+        pthread_t thread;
+        double start = now_ns();
+        if (k == 2) {
+            pthread_create(&thread, NULL, ring_producer, ring);
+        } else {
+            pthread_create(&thread, NULL, queue_producer, &args);
+        }
+        for (size_t i = 0; i < PIPELINE_ITEMS; i++) {
+            void* obj = k == 2 ? spsc_ring_pop(ring) : pop(&args);
+            while (obj == NULL) {
+                sched_yield();
+                obj = k == 2 ? spsc_ring_pop(ring) : pop(&args);
+            }
+        }
+        pthread_join(thread, NULL);
+        double elapsed = now_ns() - start;
+        printf("spsc\t%s\t%.2f Mitems/s\n", names[k],
+               PIPELINE_ITEMS / elapsed * 1e3);
+        spsc_ring_destroy(ring, NULL);
+    }
+}
+
+int main(int argc, char** argv) {
+    size_t max_threads = argc > 1 ? strtoul(argv[1], NULL, 10) : MAX_THREADS;
+    if (max_threads > MAX_THREADS) {
+        max_threads = MAX_THREADS;
+    }
+    printf("Running benchmark: %s (%d operations per thread)\n", argv[0],
+           OPS_PER_THREAD);
+
+    linked_list_t* ll = linked_list_create();
+    pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+    concurrent_queue_t* q = concurrent_queue_create();
+    uint32_t* latencies =
+        malloc(max_threads * OPS_PER_THREAD * sizeof(*latencies));
+
+    for (size_t n = 1; n <= max_threads; n *= 2) {
+        worker_args_t args = {QUEUE_MUTEX_LIST, ll, &lock, q, NULL};
+        double mutex_p99, lock_free_p99;
+        double mutex = run(&args, n, latencies, &mutex_p99);
+        args.kind = QUEUE_LOCK_FREE;
+        double lock_free = run(&args, n, latencies, &lock_free_p99);
+        printf("threads_%zu\tmutex_list\t%.2f Mops/s\tp99 %.0f ns\n", n,
+               mutex, mutex_p99);
+        printf("threads_%zu\tlock_free\t%.2f Mops/s\tp99 %.0f ns\t(%.2fx)\n",
+               n, lock_free, lock_free_p99, lock_free / mutex);
+    }
+
+    worker_args_t args = {QUEUE_MUTEX_LIST, ll, &lock, q, NULL};
+    bench_pipeline(&args);
+
+    free(latencies);
+    concurrent_queue_destroy(q, NULL);
+    linked_list_destroy(ll, NULL);
+    return 0;
+}
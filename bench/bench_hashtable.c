@@ -0,0 +1,356 @@
+#include "hashfunctions.h"
+#include "hashmap.h"
+#include "hashtable.h"
+#include <inttypes.h>
+#include <stdio.h>
+#include <time.h>
+#include <unistd.h>
+
+#define DEFAULT_NUM_KEYS 4000000
+#define NUM_LOOKUPS 4000000
+// Request-scoped workload: every request builds a few small tables
+#define NUM_REQUESTS 20000
+#define TABLES_PER_REQUEST 4
+#define KEYS_PER_TABLE 64
+#define REQUEST_ARENA_SIZE (1 << 20)
+
+uint64_t simple_hash(const char* key) {
+    uint64_t hash = 5381;
+    while (*key) {
+        hash = (hash << 5) + hash + *key++;
+    }
+    return hash;
+}
+
+static double now_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+// xorshift64* generator, so runs are reproducible
+static uint64_t next_random(uint64_t* state) {
+    *state ^= *state >> 12;
+    *state ^= *state << 25;
+    *state ^= *state >> 27;
+    return *state * 0x2545f4914f6cdd1dULL;
+}
+
+static void bench_hash_functions() {
+    size_t lens[] = {8, 64, 1024};
+    char* key = malloc(1025);
+    for (size_t i = 0; i < 1024; i++) {
+        key[i] = 'a' + i % 26;
+    }
+    for (size_t l = 0; l < 3; l++) {
+        size_t len = lens[l];
+        size_t iterations = (64 << 20) / len;
+        key[len] = '\0';
+        // Volatile so that the hashing loops are not optimized away
+        volatile uint64_t sink = 0;
+
+        double start = now_ns();
+        for (size_t i = 0; i < iterations; i++) {
+            key[0] = (char)i;
+            sink += simple_hash(key);
+        }
+        double simple = (now_ns() - start) / iterations;
+
+        start = now_ns();
+        for (size_t i = 0; i < iterations; i++) {
+            key[0] = (char)i;
+            sink += hash_wyhash(key, len, 42);
+        }
+        double wyhash = (now_ns() - start) / iterations;
+
+        key[len] = 'a';
+        printf("hash_%zu\tsimple_hash\t%.1f ns/op\t%.2f GB/s\n", len, simple,
+               len / simple);
+        printf("hash_%zu\thash_wyhash\t%.1f ns/op\t%.2f GB/s\n", len, wyhash,
+               len / wyhash);
+    }
+    free(key);
+}
+
+static void bench_lookup(const char* engine_name, hash_table_engine_t engine,
+                         char (*names)[24], size_t num_keys,
+                         const char** queries) {
+    hash_table_t* ht = hash_table_create_with_engine(16, NULL, engine);
+    for (size_t i = 0; i < num_keys; i++) {
+        hash_table_insert(ht, names[i], (void*)(i + 1));
+    }
+
+    // Serial lookups
+    size_t found = 0;
+    double start = now_ns();
+    for (size_t i = 0; i < NUM_LOOKUPS; i++) {
+        found += hash_table_lookup(ht, queries[i]) != NULL;
+    }
+    double serial = (now_ns() - start) / NUM_LOOKUPS;
+    printf("%s\tlookup_serial\t%.1f ns/op\t(%zu hits)\n", engine_name, serial,
+           found);
+
+    // Batched lookups
+    size_t batch_sizes[] = {32, 256};
+    void* out[256];
+    for (size_t b = 0; b < 2; b++) {
+        size_t batch = batch_sizes[b];
+        found = 0;
+        start = now_ns();
+        for (size_t i = 0; i + batch <= NUM_LOOKUPS; i += batch) {
+            hash_table_lookup_batch(ht, queries + i, batch, out);
+            for (size_t j = 0; j < batch; j++) {
+                found += out[j] != NULL;
+            }
+        }
+        double batched = (now_ns() - start) / NUM_LOOKUPS;
+        printf("%s\tlookup_batch_%zu\t%.1f ns/op\t(%zu hits, %.2fx)\n",
+               engine_name, batch, batched, found, serial / batched);
+    }
+
+    hash_table_destroy(ht);
+}
+
+DEFINE_HASH_MAP(id_map, uint64_t, void*)
+
+// 64-bit IDs stored in a string-keyed table, formatting every ID into a key,
+// versus a typed map storing them inline
+static void bench_u64_keys(size_t num_keys) {
+    uint64_t* ids = malloc(num_keys * sizeof(*ids));
+    uint64_t state = 0x2545f4914f6cdd1dULL;
+    for (size_t i = 0; i < num_keys; i++) {
+        ids[i] = next_random(&state);
+    }
+    uint64_t* queries = malloc(NUM_LOOKUPS * sizeof(*queries));
+    for (size_t i = 0; i < NUM_LOOKUPS; i++) {
+        queries[i] = ids[next_random(&state) % num_keys];
+    }
+
+    char key[24];
+    hash_table_t* ht =
+        hash_table_create_with_engine(16, NULL, HASH_TABLE_OPEN_ADDRESSING);
+    double start = now_ns();
+    for (size_t i = 0; i < num_keys; i++) {
+        snprintf(key, sizeof(key), "%" PRIu64, ids[i]);
+        hash_table_insert(ht, key, (void*)(i + 1));
+    }
+    double table_insert = (now_ns() - start) / num_keys;
+    size_t found = 0;
+    start = now_ns();
+    for (size_t i = 0; i < NUM_LOOKUPS; i++) {
+        snprintf(key, sizeof(key), "%" PRIu64, queries[i]);
+        found += hash_table_lookup(ht, key) != NULL;
+    }
+    double table_lookup = (now_ns() - start) / NUM_LOOKUPS;
+    hash_table_destroy(ht);
+
+    id_map_t* map = id_map_create(16);
+    start = now_ns();
+    for (size_t i = 0; i < num_keys; i++) {
+        id_map_insert(map, ids[i], (void*)(i + 1));
+    }
+    double map_insert = (now_ns() - start) / num_keys;
+    start = now_ns();
+    for (size_t i = 0; i < NUM_LOOKUPS; i++) {
+        found += id_map_lookup(map, queries[i]) != NULL;
+    }
+    double map_lookup = (now_ns() - start) / NUM_LOOKUPS;
+    id_map_destroy(map);
+
+    printf("u64_keys\tstring_table_insert\t%.1f ns/op\n", table_insert);
+    printf("u64_keys\ttyped_map_insert\t%.1f ns/op\t(%.2fx)\n", map_insert,
+           table_insert / map_insert);
+    printf("u64_keys\tstring_table_lookup\t%.1f ns/op\n", table_lookup);
+    printf("u64_keys\ttyped_map_lookup\t%.1f ns/op\t(%.2fx, %zu hits)\n",
+           map_lookup, table_lookup / map_lookup, found);
+    free(queries);
+    free(ids);
+}
+
+// Bump allocator over a fixed buffer; blocks are only reclaimed by a reset
+typedef struct {
+    char* buffer;
+    size_t used;
+} bump_t;
+
+static void* bump_alloc(void* context, size_t size) {
+    bump_t* bump = context;
+    size = (size + 15) & ~(size_t)15;
+    if (bump->used + size > REQUEST_ARENA_SIZE) {
+        return NULL;
+    }
+    void* ptr = bump->buffer + bump->used;
+    bump->used += size;
+    return ptr;
+}
+
+static void bump_free(void* context, void* ptr, size_t size) {
+    (void)context;
+    (void)ptr;
+    (void)size;
+}
+
+// Builds the tables of many requests, tearing each request down either by
+// destroying its tables or by resetting the arena they were allocated from
+static void bench_request_scoped(char (*names)[24]) {
+    bump_t bump = {aligned_alloc(16, REQUEST_ARENA_SIZE), 0};
+    allocator_t allocator = {bump_alloc, bump_free, &bump};
+    const char* variants[] = {"malloc_destroy", "arena_reset"};
+    for (size_t v = 0; v < 2; v++) {
+        double start = now_ns();
+        for (size_t r = 0; r < NUM_REQUESTS; r++) {
+            hash_table_t* tables[TABLES_PER_REQUEST];
+            for (size_t t = 0; t < TABLES_PER_REQUEST; t++) {
+                tables[t] = hash_table_create_with_allocator(
+                    16, NULL, HASH_TABLE_OPEN_ADDRESSING,
+                    v == 0 ? NULL : &allocator);
+                for (size_t k = 0; k < KEYS_PER_TABLE; k++) {
+                    hash_table_insert(tables[t], names[t * KEYS_PER_TABLE + k],
+                                      (void*)(k + 1));
+                }
+            }
+            if (v == 0) {
+                for (size_t t = 0; t < TABLES_PER_REQUEST; t++) {
+                    hash_table_destroy(tables[t]);
+                }
+            } else {
+                bump.used = 0;
+            }
+        }
+        double elapsed = (now_ns() - start) / NUM_REQUESTS;
+        printf("request\t%s\t%.0f ns/request\n", variants[v], elapsed);
+    }
+    free(bump.buffer);
+}
+
+// Memory per key and lookup latency of the mutable tables versus a frozen
+// snapshot of the same entries
+static void bench_frozen(char (*names)[24], size_t num_keys,
+                         const char** queries) {
+    hash_table_engine_t engines[] = {HASH_TABLE_CHAINING,
+                                     HASH_TABLE_OPEN_ADDRESSING};
+    const char* engine_names[] = {"chaining", "open_addressing"};
+    hash_table_t* tables[2];
+    for (size_t e = 0; e < 2; e++) {
+        tables[e] = hash_table_create_with_engine(16, NULL, engines[e]);
+        for (size_t i = 0; i < num_keys; i++) {
+            hash_table_insert(tables[e], names[i], (void*)(i + 1));
+        }
+        hash_table_stats_t stats;
+        hash_table_stats(tables[e], &stats);
+        size_t found = 0;
+        double start = now_ns();
+        for (size_t i = 0; i < NUM_LOOKUPS; i++) {
+            found += hash_table_lookup(tables[e], queries[i]) != NULL;
+        }
+        double lookup = (now_ns() - start) / NUM_LOOKUPS;
+        printf("frozen	%s_lookup	%.1f ns/op	%.1f bytes/key	(%zu hits)\n",
+               engine_names[e], lookup,
+               (double)stats.bytes_allocated / num_keys, found);
+    }
+
+    double start = now_ns();
+    frozen_hash_table_t* ft = hash_table_freeze(tables[0]);
+    double build = (now_ns() - start) / num_keys;
+    size_t found = 0;
+    start = now_ns();
+    for (size_t i = 0; i < NUM_LOOKUPS; i++) {
+        found += frozen_hash_table_lookup(ft, queries[i]) != NULL;
+    }
+    double lookup = (now_ns() - start) / NUM_LOOKUPS;
+    printf("frozen	frozen_lookup	%.1f ns/op	%.1f bytes/key	(%zu hits)\n",
+           lookup, (double)frozen_hash_table_bytes(ft) / num_keys, found);
+    printf("frozen	freeze	%.1f ns/key\n", build);
+    frozen_hash_table_destroy(ft);
+    hash_table_destroy(tables[0]);
+    hash_table_destroy(tables[1]);
+}
+
+static const void* serialize_index(const void* object, size_t* size) {
+    *size = sizeof(size_t);
+    return object;
+}
+
+// Startup cost of rebuilding a table by inserting every key versus opening a
+// snapshot of it, and lookups served from the mapped file
+static void bench_snapshot(char (*names)[24], size_t num_keys,
+                           const char** queries) {
+    char path[] = "/tmp/bench_hashtable_XXXXXX";
+    int fd = mkstemp(path);
+    if (fd < 0) {
+        return;
+    }
+    close(fd);
+
+    size_t* indices = malloc(num_keys * sizeof(*indices));
+    for (size_t i = 0; i < num_keys; i++) {
+        indices[i] = i;
+    }
+    double start = now_ns();
+    hash_table_t* ht = hash_table_create(16, NULL);
+    for (size_t i = 0; i < num_keys; i++) {
+        hash_table_insert(ht, names[i], &indices[i]);
+    }
+    double rebuild = (now_ns() - start) / 1e6;
+    start = now_ns();
+    hash_table_save(ht, path, serialize_index);
+    double save = (now_ns() - start) / 1e6;
+    hash_table_destroy(ht);
+    free(indices);
+
+    start = now_ns();
+    frozen_hash_table_t* ft = hash_table_open_mmap(path);
+    double open = (now_ns() - start) / 1e6;
+    size_t found = 0;
+    start = now_ns();
+    for (size_t i = 0; i < NUM_LOOKUPS; i++) {
+        found += frozen_hash_table_lookup(ft, queries[i]) != NULL;
+    }
+    double lookup = (now_ns() - start) / NUM_LOOKUPS;
+    printf("snapshot	rebuild	%.1f ms\n", rebuild);
+    printf("snapshot	save	%.1f ms	%.1f bytes/key\n", save,
+           (double)frozen_hash_table_bytes(ft) / num_keys);
+    printf("snapshot	open_mmap	%.1f ms	(%.1fx)\n", open, rebuild / open);
+    printf("snapshot	mapped_lookup	%.1f ns/op	(%zu hits)\n", lookup, found);
+    frozen_hash_table_destroy(ft);
+    unlink(path);
+}
+
+int main(int argc, char** argv) {
+    size_t num_keys = argc > 1 ? strtoul(argv[1], NULL, 10) : DEFAULT_NUM_KEYS;
+    printf("Running benchmark: %s (%zu keys)\n", argv[0], num_keys);
+
+    char(*names)[24] = malloc(num_keys * sizeof(*names));
+    for (size_t i = 0; i < num_keys; i++) {
+        snprintf(names[i], sizeof(names[i]), "key-%zu", i);
+    }
+    // Random queries over the whole key space, half of them misses
+    uint64_t state = 0x9e3779b97f4a7c15ULL;
+    const char** queries = malloc(NUM_LOOKUPS * sizeof(*queries));
+    char(*misses)[24] = malloc(NUM_LOOKUPS * sizeof(*misses));
+    for (size_t i = 0; i < NUM_LOOKUPS; i++) {
+        uint64_t r = next_random(&state);
+        if (r & 1) {
+            queries[i] = names[(r >> 1) % num_keys];
+        } else {
+            snprintf(misses[i], sizeof(misses[i]), "miss-%zu", i);
+            queries[i] = misses[i];
+        }
+    }
+
+    bench_hash_functions();
+    bench_lookup("chaining", HASH_TABLE_CHAINING, names, num_keys, queries);
+    bench_lookup("open_addressing", HASH_TABLE_OPEN_ADDRESSING, names, num_keys,
+                 queries);
+    bench_frozen(names, num_keys, queries);
+    bench_snapshot(names, num_keys, queries);
+    bench_u64_keys(num_keys);
+    if (num_keys >= TABLES_PER_REQUEST * KEYS_PER_TABLE) {
+        bench_request_scoped(names);
+    }
+
+    free(misses);
+    free(queries);
+    free(names);
+    return 0;
+}
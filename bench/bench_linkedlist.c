@@ -0,0 +1,366 @@
+#include "indexedlist.h"
+#include "intrusivelist.h"
+#include "linkedlist.h"
+#include "unrolledlist.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+
+#define DEFAULT_NUM_ELEMENTS 1000000
+// Size of the lists used for indexed access, which is linear in the index
+#define INDEXED_ELEMENTS 20000
+#define INDEXED_OPS 20000
+// Size of the lists used for random edits, where only sublinear lists apply
+#define EDIT_ELEMENTS 500000
+#define EDIT_OPS 20000
+
+static double now_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static linked_list_t* fill(size_t n) {
+    linked_list_t* ll = linked_list_create();
+    for (size_t i = 1; i <= n; i++) {
+        linked_list_push_back(ll, (void*)i);
+    }
+    return ll;
+}
+
+// Pops every element with `pop`, reporting the average cost per pop
+static void bench_drain(const char* name, void* (*pop)(linked_list_t*),
+                        size_t n) {
+    linked_list_t* ll = fill(n);
+    double start = now_ns();
+    size_t sum = 0;
+    void* obj;
+    while ((obj = pop(ll)) != NULL) {
+        sum += (size_t)obj;
+    }
+    double elapsed = now_ns() - start;
+    printf("%s\t%.2f ns/op\t(checksum %zu)\n", name, elapsed / n, sum);
+    linked_list_destroy(ll, NULL);
+}
+
+// Alternates pops between the two ends, as a deque would
+static void* pop_alternating(linked_list_t* ll) {
+    return linked_list_size(ll) % 2 == 0 ? linked_list_pop_front(ll)
+                                          : linked_list_pop_back(ll);
+}
+
+// Keeps a short queue alive while pushing and popping, so every push needs a
+// fresh node and every pop releases one
+static void bench_queue(size_t n) {
+    linked_list_t* ll = fill(64);
+    double start = now_ns();
+    size_t sum = 0;
+    for (size_t i = 1; i <= n; i++) {
+        linked_list_push_back(ll, (void*)i);
+        sum += (size_t)linked_list_pop_front(ll);
+    }
+    double elapsed = now_ns() - start;
+    printf("queue_push_pop\t%.2f ns/op\t(checksum %zu)\n", elapsed / n, sum);
+    linked_list_destroy(ll, NULL);
+}
+
+// xorshift64* generator, so runs are reproducible
+static uint64_t next_random(uint64_t* state) {
+    *state ^= *state >> 12;
+    *state ^= *state << 25;
+    *state ^= *state >> 27;
+    return *state * 0x2545f4914f6cdd1dULL;
+}
+
+// Random-index lookups and inserts on a plain and an unrolled list
+static void bench_indexed() {
+    linked_list_t* ll = fill(INDEXED_ELEMENTS);
+    unrolled_list_t* ul = unrolled_list_create();
+    for (size_t i = 1; i <= INDEXED_ELEMENTS; i++) {
+        unrolled_list_push_back(ul, (void*)i);
+    }
+
+    uint64_t state = 0x9e3779b97f4a7c15ULL;
+    size_t sum = 0;
+    double start = now_ns();
+    for (size_t i = 0; i < INDEXED_OPS; i++) {
+        size_t index = next_random(&state) % INDEXED_ELEMENTS;
+        sum += (size_t)linked_list_lookup(ll, index);
+    }
+    double linked = now_ns() - start;
+    state = 0x9e3779b97f4a7c15ULL;
+    start = now_ns();
+    for (size_t i = 0; i < INDEXED_OPS; i++) {
+        size_t index = next_random(&state) % INDEXED_ELEMENTS;
+        sum -= (size_t)unrolled_list_lookup(ul, index);
+    }
+    double unrolled = now_ns() - start;
+    printf("linked\tlookup_random\t%.2f ns/op\n", linked / INDEXED_OPS);
+    printf("unrolled\tlookup_random\t%.2f ns/op\t(%.2fx)\n",
+           unrolled / INDEXED_OPS, linked / unrolled);
+
+    start = now_ns();
+    for (size_t i = 0; i < INDEXED_OPS; i++) {
+        size_t index = next_random(&state) % (INDEXED_ELEMENTS + i);
+        linked_list_insert(ll, index, (void*)(i + 1));
+    }
+    linked = now_ns() - start;
+    start = now_ns();
+    for (size_t i = 0; i < INDEXED_OPS; i++) {
+        size_t index = next_random(&state) % (INDEXED_ELEMENTS + i);
+        unrolled_list_insert(ul, index, (void*)(i + 1));
+    }
+    unrolled = now_ns() - start;
+    printf("linked\tinsert_random\t%.2f ns/op\n", linked / INDEXED_OPS);
+    printf("unrolled\tinsert_random\t%.2f ns/op\t(%.2fx)\t(checksum %zu)\n",
+           unrolled / INDEXED_OPS, linked / unrolled, sum);
+
+    linked_list_destroy(ll, NULL);
+    unrolled_list_destroy(ul, NULL);
+}
+
+typedef struct {
+    size_t value;
+    intrusive_link_t link;
+} item_t;
+
+// Same queue workload with objects that embed their link, so neither pushes
+// nor pops allocate, followed by a traversal summing the objects
+static void bench_intrusive_queue(size_t n) {
+    item_t* items = malloc(65 * sizeof(*items));
+    intrusive_list_t list;
+    intrusive_list_init(&list);
+    for (size_t i = 0; i < 64; i++) {
+        items[i].value = i;
+        intrusive_list_push_back(&list, &items[i].link);
+    }
+    items[64].value = 64;
+    intrusive_link_t* spare = &items[64].link;
+    double start = now_ns();
+    size_t sum = 0;
+    for (size_t i = 1; i <= n; i++) {
+        intrusive_list_push_back(&list, spare);
+        spare = intrusive_list_pop_front(&list);
+        sum += intrusive_list_entry(spare, item_t, link)->value;
+    }
+    double elapsed = now_ns() - start;
+    printf("intrusive_queue_push_pop\t%.2f ns/op\t(checksum %zu)\n",
+           elapsed / n, sum);
+    free(items);
+
+    // Traverse n objects, linked in the order they were allocated, through
+    // each list type
+    items = malloc(n * sizeof(*items));
+    intrusive_list_init(&list);
+    linked_list_t* ll = linked_list_create();
+    for (size_t i = 0; i < n; i++) {
+        items[i].value = i;
+        intrusive_list_push_back(&list, &items[i].link);
+        linked_list_push_back(ll, &items[i]);
+    }
+    start = now_ns();
+    sum = 0;
+    linked_list_cursor_t cursor = linked_list_cursor_front(ll);
+    while (linked_list_cursor_valid(&cursor)) {
+        sum += ((item_t*)linked_list_cursor_get(&cursor))->value;
+        linked_list_cursor_next(&cursor);
+    }
+    double wrapped = now_ns() - start;
+    start = now_ns();
+    intrusive_list_foreach(pos, &list) {
+        sum -= intrusive_list_entry(pos, item_t, link)->value;
+    }
+    double intrusive = now_ns() - start;
+    printf("linked\ttraverse_objects\t%.2f ns/element\n", wrapped / n);
+    printf("intrusive\ttraverse_objects\t%.2f ns/element\t(checksum %zu)\n",
+           intrusive / n, sum);
+    linked_list_destroy(ll, NULL);
+    free(items);
+}
+
+// Moves a list of n elements onto another one element by element, then with
+// a splice; builds a list with one bulk push; and exports it to an array
+static void bench_bulk(size_t n) {
+    linked_list_t* dst = linked_list_create();
+    linked_list_t* src = fill(n);
+    double start = now_ns();
+    void* obj;
+    while ((obj = linked_list_pop_front(src)) != NULL) {
+        linked_list_push_back(dst, obj);
+    }
+    double moved = now_ns() - start;
+    linked_list_destroy(src, NULL);
+    src = fill(n);
+    start = now_ns();
+    linked_list_splice(dst, src);
+    double spliced = now_ns() - start;
+    printf("linked\tmove_one_by_one\t%.2f ms\n", moved / 1e6);
+    printf("linked\tsplice\t%.2f ms\n", spliced / 1e6);
+    linked_list_destroy(src, NULL);
+
+    void** array = linked_list_to_array(dst);
+    start = now_ns();
+    linked_list_t* ll = linked_list_create();
+    for (size_t i = 0; i < n; i++) {
+        linked_list_push_back(ll, array[i]);
+    }
+    double pushed = now_ns() - start;
+    linked_list_destroy(ll, NULL);
+    start = now_ns();
+    ll = linked_list_create();
+    linked_list_push_back_many(ll, array, n);
+    double pushed_many = now_ns() - start;
+    free(array);
+    start = now_ns();
+    array = linked_list_to_array(ll);
+    double exported = now_ns() - start;
+    printf("linked\tpush_back\t%.2f ns/element\n", pushed / n);
+    printf("linked\tpush_back_many\t%.2f ns/element\n", pushed_many / n);
+    printf("linked\tto_array\t%.2f ns/element\n", exported / n);
+    free(array);
+    linked_list_destroy(ll, NULL);
+    linked_list_destroy(dst, NULL);
+}
+
+static int compare_values(const void* a, const void* b) {
+    size_t x = (size_t)a;
+    size_t y = (size_t)b;
+    return (x > y) - (x < y);
+}
+
+static int compare_array_values(const void* a, const void* b) {
+    return compare_values(*(void* const*)a, *(void* const*)b);
+}
+
+static linked_list_t* fill_random(size_t n) {
+    linked_list_t* ll = linked_list_create();
+    uint64_t state = 0x9e3779b97f4a7c15ULL;
+    for (size_t i = 0; i < n; i++) {
+        linked_list_push_back(ll, (void*)(next_random(&state) | 1));
+    }
+    return ll;
+}
+
+// Sorts n random values by exporting to an array, qsort and rebuilding, then
+// in place, sequentially and on several threads
+static void bench_sort(size_t n) {
+    linked_list_t* ll = fill_random(n);
+    double start = now_ns();
+    void** array = linked_list_to_array(ll);
+    qsort(array, n, sizeof(*array), compare_array_values);
+    linked_list_destroy(ll, NULL);
+    ll = linked_list_create();
+    linked_list_push_back_many(ll, array, n);
+    free(array);
+    double elapsed = now_ns() - start;
+    printf("linked\tsort_via_qsort\t%.2f ms\n", elapsed / 1e6);
+    linked_list_destroy(ll, NULL);
+
+    size_t threads[] = {1, 2, 4, 8};
+    for (size_t t = 0; t < 4; t++) {
+        ll = fill_random(n);
+        start = now_ns();
+        linked_list_sort_parallel(ll, compare_values, threads[t]);
+        elapsed = now_ns() - start;
+        printf("linked\tsort_threads_%zu\t%.2f ms\n", threads[t],
+               elapsed / 1e6);
+        linked_list_destroy(ll, NULL);
+    }
+}
+
+// Random positional inserts, deletes and lookups, as an editor buffer
+// would see, on an unrolled and an indexed list of EDIT_ELEMENTS
+static void bench_edits() {
+    unrolled_list_t* ul = unrolled_list_create();
+    indexed_list_t* il = indexed_list_create();
+    for (size_t i = 1; i <= EDIT_ELEMENTS; i++) {
+        unrolled_list_push_back(ul, (void*)i);
+        indexed_list_push_back(il, (void*)i);
+    }
+
+    uint64_t state = 0x9e3779b97f4a7c15ULL;
+    size_t sum = 0;
+    double start = now_ns();
+    for (size_t i = 0; i < EDIT_OPS; i++) {
+        uint64_t r = next_random(&state);
+        size_t index = (r >> 2) % unrolled_list_size(ul);
+        if ((r & 3) == 0) {
+            unrolled_list_insert(ul, index, (void*)(i + 1));
+        } else if ((r & 3) == 1) {
+            sum += (size_t)unrolled_list_delete(ul, index);
+        } else {
+            sum += (size_t)unrolled_list_lookup(ul, index);
+        }
+    }
+    double unrolled = now_ns() - start;
+    state = 0x9e3779b97f4a7c15ULL;
+    start = now_ns();
+    for (size_t i = 0; i < EDIT_OPS; i++) {
+        uint64_t r = next_random(&state);
+        size_t index = (r >> 2) % indexed_list_size(il);
+        if ((r & 3) == 0) {
+            indexed_list_insert(il, index, (void*)(i + 1));
+        } else if ((r & 3) == 1) {
+            sum -= (size_t)indexed_list_delete(il, index);
+        } else {
+            sum -= (size_t)indexed_list_lookup(il, index);
+        }
+    }
+    double indexed = now_ns() - start;
+    printf("unrolled\tedit_random\t%.2f ns/op\n", unrolled / EDIT_OPS);
+    printf("indexed\tedit_random\t%.2f ns/op\t(%.2fx)\t(checksum %zu)\n",
+           indexed / EDIT_OPS, unrolled / indexed, sum);
+
+    unrolled_list_destroy(ul, NULL);
+    indexed_list_destroy(il, NULL);
+}
+
+// Removes every odd element, once by index and once through a cursor
+static void bench_filter() {
+    linked_list_t* ll = fill(INDEXED_ELEMENTS);
+    double start = now_ns();
+    for (size_t i = 0; i < linked_list_size(ll);) {
+        if ((size_t)linked_list_lookup(ll, i) % 2 == 1) {
+            linked_list_delete(ll, i);
+        } else {
+            i++;
+        }
+    }
+    double indexed = now_ns() - start;
+    linked_list_destroy(ll, NULL);
+
+    ll = fill(INDEXED_ELEMENTS);
+    start = now_ns();
+    linked_list_cursor_t cursor = linked_list_cursor_front(ll);
+    while (linked_list_cursor_valid(&cursor)) {
+        if ((size_t)linked_list_cursor_get(&cursor) % 2 == 1) {
+            linked_list_cursor_remove(&cursor);
+        } else {
+            linked_list_cursor_next(&cursor);
+        }
+    }
+    double cursor_ns = now_ns() - start;
+    linked_list_destroy(ll, NULL);
+
+    printf("linked\tfilter_indexed\t%.2f ns/element\n",
+           indexed / INDEXED_ELEMENTS);
+    printf("linked\tfilter_cursor\t%.2f ns/element\t(%.0fx)\n",
+           cursor_ns / INDEXED_ELEMENTS, indexed / cursor_ns);
+}
+
+int main(int argc, char** argv) {
+    size_t n = argc > 1 ? strtoul(argv[1], NULL, 10) : DEFAULT_NUM_ELEMENTS;
+    printf("Running benchmark: %s (%zu elements)\n", argv[0], n);
+
+    bench_drain("pop_front", linked_list_pop_front, n);
+    bench_drain("pop_back", linked_list_pop_back, n);
+    bench_drain("pop_both_ends", pop_alternating, n);
+    bench_queue(n * 10);
+    bench_intrusive_queue(n);
+    bench_bulk(n);
+    bench_sort(n);
+    bench_indexed();
+    bench_filter();
+    bench_edits();
+    return 0;
+}
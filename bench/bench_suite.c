@@ -0,0 +1,413 @@
+#include "hashfunctions.h"
+#include "hashtable.h"
+#include "linkedlist.h"
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+
+// Reproducible benchmark suite for hash_table_* and linked_list_*, printing
+// one CSV row per measurement so that runs of two versions can be diffed.
+//
+// Operations are timed in batches of BATCH_OPS; p50 and p99 are percentiles
+// of the average per-operation time of a batch, after subtracting the cost of
+// reading the clock, so they understate the tail of single operations. Sizes
+// range from tables that fit in L1 to ones larger than the last level cache;
+// the `bytes` column reports the actual footprint.
+//
+// Keys, queries and operation orders come from fixed-seed generators, and
+// tables hash with wyhash under a fixed seed instead of a random per-table
+// one, so every run lays out the tables identically.
+
+#define BATCH_OPS 16
+#define HASH_SEED 0x243f6a8885a308d3ULL
+// Lookups timed per configuration, and minimum number of inserts, deletes,
+// pushes and pops, repeating the run on fresh containers for small sizes
+#define NUM_OPS 1000000
+// Indexed list access is linear in the index, so it is only measured on
+// lists up to this size, with fewer operations
+#define MAX_INDEX_SIZE 16384
+#define INDEX_OPS 20000
+#define ZIPF_EXPONENT 0.99
+#define KEY_SIZE 24
+
+static const size_t sizes[] = {512, 16384, 524288, 4194304};
+#define NUM_SIZES (sizeof(sizes) / sizeof(sizes[0]))
+
+typedef struct {
+    uint32_t* samples;
+    size_t num_samples;
+    size_t capacity;
+    size_t ops;
+    double elapsed;
+} recorder_t;
+
+// Runs operations [begin, end) of a measurement
+typedef void batch_func(void* ctx, size_t begin, size_t end);
+
+static double timer_overhead;
+
+static uint64_t fixed_seed_hash(const void* key, size_t len) {
+    return hash_wyhash(key, len, HASH_SEED);
+}
+
+static double now_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static uint64_t next_random(uint64_t* state) {
+    uint64_t x = *state;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    *state = x;
+    return x * 0x2545f4914f6cdd1dULL;
+}
+
+// Uniform double in [0, 1)
+static double next_uniform(uint64_t* state) {
+    return (next_random(state) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+static int compare_samples(const void* a, const void* b) {
+    uint32_t x = *(const uint32_t*)a;
+    uint32_t y = *(const uint32_t*)b;
+    return (x > y) - (x < y);
+}
+
+// Median cost of the two clock reads surrounding every batch
+static void calibrate_timer() {
+    uint32_t samples[1001];
+    for (size_t i = 0; i < 1001; i++) {
+        double start = now_ns();
+        samples[i] = (uint32_t)(now_ns() - start);
+    }
+    qsort(samples, 1001, sizeof(samples[0]), compare_samples);
+    timer_overhead = samples[500];
+}
+
+static void recorder_init(recorder_t* rec) {
+    rec->samples = NULL;
+    rec->num_samples = 0;
+    rec->capacity = 0;
+    rec->ops = 0;
+    rec->elapsed = 0;
+}
+
+static void recorder_run(recorder_t* rec, batch_func* func, void* ctx,
+                         size_t begin, size_t end) {
+    size_t needed = rec->num_samples + (end - begin) / BATCH_OPS + 1;
+    if (needed > rec->capacity) {
+        rec->capacity = needed * 2;
+        rec->samples =
+            realloc(rec->samples, rec->capacity * sizeof(*rec->samples));
+    }
+    for (size_t i = begin; i < end; i += BATCH_OPS) {
+        size_t batch_end = i + BATCH_OPS < end ? i + BATCH_OPS : end;
+        double start = now_ns();
+        func(ctx, i, batch_end);
+        double elapsed = now_ns() - start - timer_overhead;
+        if (elapsed < 0) {
+            elapsed = 0;
+        }
+        rec->elapsed += elapsed;
+        // Per-operation time, in tenths of a nanosecond
+        rec->samples[rec->num_samples++] =
+            (uint32_t)(elapsed * 10 / (batch_end - i));
+    }
+    rec->ops += end - begin;
+}
+
+// Prints the CSV row of a measurement and resets the recorder
+static void recorder_report(recorder_t* rec, const char* structure,
+                            const char* variant, const char* operation,
+                            const char* distribution, const char* hit_ratio,
+                            size_t size, size_t bytes) {
+    qsort(rec->samples, rec->num_samples, sizeof(*rec->samples),
+          compare_samples);
+    double p50 = rec->samples[rec->num_samples / 2] / 10.0;
+    double p99 = rec->samples[rec->num_samples * 99 / 100] / 10.0;
+    printf("%s,%s,%s,%s,%s,%zu,", structure, variant, operation, distribution,
+           hit_ratio, size);
+    if (bytes > 0) {
+        printf("%zu", bytes);
+    }
+    printf(",%zu,%.2f,%.1f,%.1f\n", rec->ops, rec->elapsed / rec->ops, p50,
+           p99);
+    fflush(stdout);
+    free(rec->samples);
+    recorder_init(rec);
+}
+
+// Cumulative distribution of a Zipf law over `n` ranks
+static double* zipf_cdf(size_t n) {
+    double* cdf = malloc(n * sizeof(*cdf));
+    double sum = 0;
+    for (size_t i = 0; i < n; i++) {
+        sum += 1.0 / pow((double)(i + 1), ZIPF_EXPONENT);
+        cdf[i] = sum;
+    }
+    for (size_t i = 0; i < n; i++) {
+        cdf[i] /= sum;
+    }
+    return cdf;
+}
+
+// Draws a rank in [0, n), uniformly or following `cdf` if it is not NULL
+static size_t draw(uint64_t* state, size_t n, const double* cdf) {
+    if (cdf == NULL) {
+        return next_random(state) % n;
+    }
+    double u = next_uniform(state);
+    size_t lo = 0;
+    size_t hi = n - 1;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (cdf[mid] < u) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+typedef struct {
+    hash_table_t* ht;
+    char (*keys)[KEY_SIZE];
+    const char** queries;
+    size_t found;
+} table_ctx_t;
+
+static void table_insert(void* ptr, size_t begin, size_t end) {
+    table_ctx_t* ctx = ptr;
+    for (size_t i = begin; i < end; i++) {
+        hash_table_insert(ctx->ht, ctx->keys[i], (void*)(i + 1));
+    }
+}
+
+static void table_lookup(void* ptr, size_t begin, size_t end) {
+    table_ctx_t* ctx = ptr;
+    for (size_t i = begin; i < end; i++) {
+        ctx->found += hash_table_lookup(ctx->ht, ctx->queries[i]) != NULL;
+    }
+}
+
+static void table_delete(void* ptr, size_t begin, size_t end) {
+    table_ctx_t* ctx = ptr;
+    for (size_t i = begin; i < end; i++) {
+        ctx->found += hash_table_delete(ctx->ht, ctx->queries[i]) != NULL;
+    }
+}
+
+static void bench_table(const char* variant, hash_table_engine_t engine,
+                        size_t size, char (*keys)[KEY_SIZE],
+                        char (*misses)[KEY_SIZE], const double* cdf) {
+    recorder_t rec;
+    recorder_init(&rec);
+    size_t num_queries = size > NUM_OPS ? size : NUM_OPS;
+    table_ctx_t ctx = {NULL, keys, malloc(num_queries * sizeof(char*)), 0};
+    uint64_t state = 0x9e3779b97f4a7c15ULL;
+
+    // Inserts into a table growing from its minimum size
+    size_t rounds = (NUM_OPS + size - 1) / size;
+    for (size_t r = 0; r < rounds; r++) {
+        if (ctx.ht != NULL) {
+            hash_table_destroy(ctx.ht);
+        }
+        ctx.ht = hash_table_create_n(16, fixed_seed_hash, engine);
+        recorder_run(&rec, table_insert, &ctx, 0, size);
+    }
+    hash_table_stats_t stats;
+    hash_table_stats(ctx.ht, &stats);
+    recorder_report(&rec, "hash_table", variant, "insert", "uniform", "", size,
+                    stats.bytes_allocated);
+
+    const char* distributions[] = {"uniform", "zipf", "uniform", "uniform"};
+    const char* hit_ratios[] = {"1.0", "1.0", "0.5", "0.0"};
+    for (size_t d = 0; d < 4; d++) {
+        double hit_ratio = atof(hit_ratios[d]);
+        for (size_t i = 0; i < NUM_OPS; i++) {
+            size_t rank = draw(&state, size, d == 1 ? cdf : NULL);
+            bool hit = next_uniform(&state) < hit_ratio;
+            ctx.queries[i] = hit ? keys[rank] : misses[i];
+        }
+        recorder_run(&rec, table_lookup, &ctx, 0, NUM_OPS);
+        recorder_report(&rec, "hash_table", variant, "lookup",
+                        distributions[d], hit_ratios[d], size,
+                        stats.bytes_allocated);
+    }
+
+    // Deletes every key in random order, shrinking the table
+    for (size_t r = 0; r < rounds; r++) {
+        for (size_t i = 0; i < size; i++) {
+            ctx.queries[i] = keys[i];
+        }
+        for (size_t i = size - 1; i > 0; i--) {
+            size_t j = next_random(&state) % (i + 1);
+            const char* tmp = ctx.queries[i];
+            ctx.queries[i] = ctx.queries[j];
+            ctx.queries[j] = tmp;
+        }
+        if (r > 0) {
+            hash_table_destroy(ctx.ht);
+            ctx.ht = hash_table_create_n(16, fixed_seed_hash, engine);
+            table_insert(&ctx, 0, size);
+        }
+        recorder_run(&rec, table_delete, &ctx, 0, size);
+    }
+    recorder_report(&rec, "hash_table", variant, "delete", "uniform", "1.0",
+                    size, stats.bytes_allocated);
+
+    hash_table_destroy(ctx.ht);
+    free(ctx.queries);
+}
+
+typedef struct {
+    linked_list_t* ll;
+    size_t* indices;
+    size_t sum;
+} list_ctx_t;
+
+static void list_push_back(void* ptr, size_t begin, size_t end) {
+    list_ctx_t* ctx = ptr;
+    for (size_t i = begin; i < end; i++) {
+        linked_list_push_back(ctx->ll, (void*)(i + 1));
+    }
+}
+
+static void list_push_front(void* ptr, size_t begin, size_t end) {
+    list_ctx_t* ctx = ptr;
+    for (size_t i = begin; i < end; i++) {
+        linked_list_push_front(ctx->ll, (void*)(i + 1));
+    }
+}
+
+static void list_pop_front(void* ptr, size_t begin, size_t end) {
+    list_ctx_t* ctx = ptr;
+    for (size_t i = begin; i < end; i++) {
+        ctx->sum += (size_t)linked_list_pop_front(ctx->ll);
+    }
+}
+
+static void list_pop_back(void* ptr, size_t begin, size_t end) {
+    list_ctx_t* ctx = ptr;
+    for (size_t i = begin; i < end; i++) {
+        ctx->sum += (size_t)linked_list_pop_back(ctx->ll);
+    }
+}
+
+static void list_lookup(void* ptr, size_t begin, size_t end) {
+    list_ctx_t* ctx = ptr;
+    for (size_t i = begin; i < end; i++) {
+        ctx->sum += (size_t)linked_list_lookup(ctx->ll, ctx->indices[i]);
+    }
+}
+
+// Visits elements [begin, end) of the list in order through a cursor kept
+// across batches
+static linked_list_cursor_t traversal;
+
+static void list_traverse(void* ptr, size_t begin, size_t end) {
+    list_ctx_t* ctx = ptr;
+    for (size_t i = begin; i < end; i++) {
+        ctx->sum += (size_t)linked_list_cursor_get(&traversal);
+        linked_list_cursor_next(&traversal);
+    }
+}
+
+// Fills an empty list with `push`, then drains it with `pop`
+static void bench_list_ends(recorder_t* push_rec, recorder_t* pop_rec,
+                            batch_func* push, batch_func* pop, size_t size) {
+    size_t rounds = (NUM_OPS + size - 1) / size;
+    list_ctx_t ctx = {linked_list_create(), NULL, 0};
+    for (size_t r = 0; r < rounds; r++) {
+        recorder_run(push_rec, push, &ctx, 0, size);
+        recorder_run(pop_rec, pop, &ctx, 0, size);
+    }
+    linked_list_destroy(ctx.ll, NULL);
+}
+
+static void bench_list(size_t size, const double* cdf) {
+    recorder_t push_rec;
+    recorder_t pop_rec;
+    recorder_init(&push_rec);
+    recorder_init(&pop_rec);
+    // Queue and stack usage
+    bench_list_ends(&push_rec, &pop_rec, list_push_back, list_pop_front, size);
+    recorder_report(&push_rec, "linked_list", "pool", "push_back", "", "",
+                    size, 0);
+    recorder_report(&pop_rec, "linked_list", "pool", "pop_front", "", "",
+                    size, 0);
+    bench_list_ends(&push_rec, &pop_rec, list_push_front, list_pop_back, size);
+    recorder_report(&push_rec, "linked_list", "pool", "push_front", "", "",
+                    size, 0);
+    recorder_report(&pop_rec, "linked_list", "pool", "pop_back", "", "",
+                    size, 0);
+
+    list_ctx_t ctx = {linked_list_create(), NULL, 0};
+    list_push_back(&ctx, 0, size);
+
+    size_t rounds = (NUM_OPS + size - 1) / size;
+    for (size_t r = 0; r < rounds; r++) {
+        traversal = linked_list_cursor_front(ctx.ll);
+        recorder_run(&push_rec, list_traverse, &ctx, 0, size);
+    }
+    recorder_report(&push_rec, "linked_list", "pool", "traverse", "", "",
+                    size, 0);
+
+    // Indexed access, with Zipf ranks favouring the front of the list
+    if (size <= MAX_INDEX_SIZE) {
+        ctx.indices = malloc(INDEX_OPS * sizeof(size_t));
+        uint64_t state = 0x9e3779b97f4a7c15ULL;
+        const char* distributions[] = {"uniform", "zipf"};
+        for (size_t d = 0; d < 2; d++) {
+            for (size_t i = 0; i < INDEX_OPS; i++) {
+                ctx.indices[i] = draw(&state, size, d == 1 ? cdf : NULL);
+            }
+            recorder_run(&push_rec, list_lookup, &ctx, 0, INDEX_OPS);
+            recorder_report(&push_rec, "linked_list", "pool", "lookup_index",
+                            distributions[d], "", size, 0);
+        }
+        free(ctx.indices);
+    }
+    linked_list_destroy(ctx.ll, NULL);
+}
+
+int main(int argc, char** argv) {
+    size_t max_size = argc > 1 ? strtoul(argv[1], NULL, 10) : SIZE_MAX;
+    // Keep stdout pure CSV
+    fprintf(stderr, "Running benchmark: %s\n", argv[0]);
+    calibrate_timer();
+
+    size_t largest = 0;
+    for (size_t s = 0; s < NUM_SIZES && sizes[s] <= max_size; s++) {
+        largest = sizes[s];
+    }
+    char(*keys)[KEY_SIZE] = malloc(largest * sizeof(*keys));
+    for (size_t i = 0; i < largest; i++) {
+        snprintf(keys[i], KEY_SIZE, "key-%zu", i);
+    }
+    char(*misses)[KEY_SIZE] = malloc(NUM_OPS * sizeof(*misses));
+    for (size_t i = 0; i < NUM_OPS; i++) {
+        snprintf(misses[i], KEY_SIZE, "miss-%zu", i);
+    }
+
+    printf("structure,variant,operation,distribution,hit_ratio,size,bytes,"
+           "ops,ns_per_op,p50_batch16_ns,p99_batch16_ns\n");
+    for (size_t s = 0; s < NUM_SIZES && sizes[s] <= max_size; s++) {
+        double* cdf = zipf_cdf(sizes[s]);
+        bench_table("chaining", HASH_TABLE_CHAINING, sizes[s], keys, misses,
+                    cdf);
+        bench_table("open_addressing", HASH_TABLE_OPEN_ADDRESSING, sizes[s],
+                    keys, misses, cdf);
+        bench_list(sizes[s], cdf);
+        free(cdf);
+    }
+
+    free(misses);
+    free(keys);
+    return 0;
+}
@@ -0,0 +1,204 @@
+#include "linkedlist.h"
+#include "workdeque.h"
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+
+// The benchmark sums a function over [0, TREE_SIZE) by recursively splitting
+// the range in halves down to LEAF_SIZE elements, like a parallel tree sum.
+// Leaves are kept small so that scheduling costs show.
+#define TREE_SIZE (1ul << 24)
+#define LEAF_SIZE 32
+// Every configuration is timed this many times and the best run is kept
+#define RUNS 3
+#define MAX_THREADS 32
+
+typedef enum { POOL_MUTEX_LIST, POOL_WORK_DEQUE } pool_kind_t;
+
+typedef struct {
+    pool_kind_t kind;
+    size_t num_threads;
+    work_deque_t* deques[MAX_THREADS];
+    linked_list_t* lists[MAX_THREADS];
+    pthread_mutex_t locks[MAX_THREADS];
+    // Tasks pushed or running but not finished yet
+    _Atomic size_t pending;
+    uint64_t sums[MAX_THREADS];
+} pool_t;
+
+typedef struct {
+    pool_t* pool;
+    size_t id;
+} worker_args_t;
+
+static double now_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static uint64_t leaf_value(uint64_t i) {
+    i ^= i >> 33;
+    i *= 0xff51afd7ed558ccdull;
+    i ^= i >> 33;
+    return i;
+}
+
+static uint64_t sum_range(uint64_t lo, uint64_t len) {
+    uint64_t sum = 0;
+    for (uint64_t i = lo; i < lo + len; i++) {
+        sum += leaf_value(i);
+    }
+    return sum;
+}
+
+// A task is a range [lo, lo + len) with len a power of two and lo a multiple
+// of len, encoded as lo | len / 2 so that the lowest set bit gives len back
+static void* task_encode(uint64_t lo, uint64_t len) {
+    return (void*)(uintptr_t)(lo | len / 2);
+}
+
+static void push(pool_t* pool, size_t id, void* task) {
+    if (pool->kind == POOL_WORK_DEQUE) {
+        work_deque_push(pool->deques[id], task);
+    } else {
+        pthread_mutex_lock(&pool->locks[id]);
+        linked_list_push_back(pool->lists[id], task);
+        pthread_mutex_unlock(&pool->locks[id]);
+    }
+}
+
+static void* pop(pool_t* pool, size_t id) {
+    if (pool->kind == POOL_WORK_DEQUE) {
+        return work_deque_pop(pool->deques[id]);
+    }
+    pthread_mutex_lock(&pool->locks[id]);
+    void* task = linked_list_pop_back(pool->lists[id]);
+    pthread_mutex_unlock(&pool->locks[id]);
+    return task;
+}
+
+static void* steal(pool_t* pool, size_t victim) {
+    if (pool->kind == POOL_WORK_DEQUE) {
+        return work_deque_steal(pool->deques[victim]);
+    }
+    pthread_mutex_lock(&pool->locks[victim]);
+    void* task = linked_list_pop_front(pool->lists[victim]);
+    pthread_mutex_unlock(&pool->locks[victim]);
+    return task;
+}
+
+// Each worker runs its own tasks depth first and steals the oldest, largest
+// task of a random victim when it runs out
+static void* worker(void* ptr) {
+    worker_args_t* args = ptr;
+    pool_t* pool = args->pool;
+    uint64_t sum = 0;
+    uint64_t seed = args->id * 0x9e3779b97f4a7c15ull + 1;
+    while (atomic_load(&pool->pending) > 0) {
+        void* task = pop(pool, args->id);
+        if (task == NULL && pool->num_threads > 1) {
+            seed ^= seed << 13;
+            seed ^= seed >> 7;
+            seed ^= seed << 17;
+            task = steal(pool, seed % pool->num_threads);
+        }
+        if (task == NULL) {
+            sched_yield();
+            continue;
+        }
+        uint64_t bits = (uintptr_t)task;
+        uint64_t len = (bits & -bits) * 2;
+        uint64_t lo = bits & ~(len - 1);
+        while (len > LEAF_SIZE) {
+            len /= 2;
+            atomic_fetch_add(&pool->pending, 1);
+            push(pool, args->id, task_encode(lo + len, len));
+        }
+        sum += sum_range(lo, len);
+        atomic_fetch_sub(&pool->pending, 1);
+    }
+    pool->sums[args->id] = sum;
+    return NULL;
+}
+
+// Sums the tree on `num_threads` workers, returning the elapsed milliseconds
+static double run_once(pool_t* pool, size_t num_threads, uint64_t expected) {
+    pthread_t threads[MAX_THREADS];
+    worker_args_t args[MAX_THREADS];
+    pool->num_threads = num_threads;
+    atomic_store(&pool->pending, 1);
+    push(pool, 0, task_encode(0, TREE_SIZE));
+    double start = now_ns();
+    for (size_t t = 0; t < num_threads; t++) {
+        args[t].pool = pool;
+        args[t].id = t;
+        pthread_create(&threads[t], NULL, worker, &args[t]);
+    }
+    uint64_t sum = 0;
+    for (size_t t = 0; t < num_threads; t++) {
+        pthread_join(threads[t], NULL);
+        sum += pool->sums[t];
+    }
+    double elapsed = now_ns() - start;
+    if (sum != expected) {
+        printf("wrong sum: %llu\n", (unsigned long long)sum);
+    }
+    return elapsed / 1e6;
+}
+
+static double run(pool_t* pool, size_t num_threads, uint64_t expected) {
+    double best = run_once(pool, num_threads, expected);
+    for (size_t r = 1; r < RUNS; r++) {
+        double elapsed = run_once(pool, num_threads, expected);
+        best = elapsed < best ? elapsed : best;
+    }
+    return best;
+}
+
+int main(int argc, char** argv) {
+    size_t max_threads = argc > 1 ? strtoul(argv[1], NULL, 10) : 8;
+    if (max_threads > MAX_THREADS) {
+        max_threads = MAX_THREADS;
+    }
+    size_t num_tasks = 2 * TREE_SIZE / LEAF_SIZE - 1;
+    printf("Running benchmark: %s (%lu elements, %zu tasks)\n", argv[0],
+           TREE_SIZE, num_tasks);
+
+    // Serial baseline running the same leaves without any scheduling
+    uint64_t expected = 0;
+    double start = now_ns();
+    for (uint64_t lo = 0; lo < TREE_SIZE; lo += LEAF_SIZE) {
+        expected += sum_range(lo, LEAF_SIZE);
+    }
+    double serial = (now_ns() - start) / 1e6;
+    printf("serial\t%.1f ms\n", serial);
+
+    pool_t* pool = calloc(1, sizeof(*pool));
+    for (size_t t = 0; t < MAX_THREADS; t++) {
+        pool->deques[t] = work_deque_create(64);
+        pool->lists[t] = linked_list_create();
+        pthread_mutex_init(&pool->locks[t], NULL);
+    }
+    for (size_t n = 1; n <= max_threads; n *= 2) {
+        pool->kind = POOL_MUTEX_LIST;
+        double mutex = run(pool, n, expected);
+        pool->kind = POOL_WORK_DEQUE;
+        double deque = run(pool, n, expected);
+        // Scheduling overhead is the time beyond the serial leaves, per task
+        printf("threads_%zu\tmutex_list\t%.1f ms\t%.1f ns/task\n", n, mutex,
+               (mutex - serial) * 1e6 / num_tasks);
+        printf("threads_%zu\twork_deque\t%.1f ms\t%.1f ns/task\t(%.2fx)\n", n,
+               deque, (deque - serial) * 1e6 / num_tasks, mutex / deque);
+    }
+    for (size_t t = 0; t < MAX_THREADS; t++) {
+        work_deque_destroy(pool->deques[t]);
+        linked_list_destroy(pool->lists[t], NULL);
+        pthread_mutex_destroy(&pool->locks[t]);
+    }
+    free(pool);
+    return 0;
+}
@@ -0,0 +1,41 @@
+/**
+ * @file allocator.h
+ * @brief Header file for the pluggable memory allocator interface.
+ *
+ * Containers created with an allocator obtain all of their memory from it:
+ * the container itself, bucket and slot arrays, entries, key copies and list
+ * nodes. This lets them be backed by per-request arenas, hugepage pools or
+ * thread-local caches. Most small blocks are carved out of larger chunks
+ * obtained from the allocator, so it sees few, mostly large, requests.
+ *
+ * An allocator whose `free` does nothing is valid: the containers built on
+ * it can then be dropped wholesale by resetting the underlying arena instead
+ * of being destroyed one by one.
+ */
+
+#ifndef ALLOCATOR_H
+#define ALLOCATOR_H
+
+#include <stddef.h>
+
+/**
+ * @brief Allocator vtable. A container keeps its own copy of the structure,
+ * so it does not need to outlive the call that creates the container; the
+ * `context` it points to must outlive the container.
+ */
+typedef struct {
+    /**
+     * Allocates `size` bytes aligned for any type, as malloc() does. Returns
+     * NULL on failure.
+     */
+    void* (*alloc)(void* context, size_t size);
+    /**
+     * Frees a block returned by `alloc`. `size` is the size that was
+     * requested for it. Never called with a NULL pointer.
+     */
+    void (*free)(void* context, void* ptr, size_t size);
+    /** Opaque pointer passed to both functions. */
+    void* context;
+} allocator_t;
+
+#endif // ALLOCATOR_H
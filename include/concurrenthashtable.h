@@ -0,0 +1,95 @@
+/**
+ * @file concurrenthashtable.h
+ * @brief Header file for a thread-safe hash table implementation in C.
+ *
+ * This hash table has the same insertion, lookup, and deletion semantics as
+ * `hash_table_t`, but can be shared between threads without external locking.
+ * Lookups never take a lock: they traverse the chains with atomic loads while
+ * writers serialize only on the lock stripe covering the key's bucket.
+ * Deleted entries are reclaimed with epoch-based reclamation once no reader
+ * can still be traversing them.
+ */
+
+#ifndef CONCURRENTHASHTABLE_H
+#define CONCURRENTHASHTABLE_H
+
+#include "hashtable.h"
+
+/**
+ * @struct _concurrent_hash_table
+ * @brief Opaque structure representing a thread-safe hash table.
+ */
+typedef struct _concurrent_hash_table concurrent_hash_table_t;
+
+/**
+ * @brief Creates a new thread-safe hash table.
+ *
+ * The table grows when the number of stored entries exceeds the number of
+ * buckets. Entries are moved to the larger bucket array a few chains at a
+ * time by subsequent insertions and deletions, so no operation waits for the
+ * whole table to be rehashed.
+ *
+ * @param size The initial number of buckets in the hash table, rounded up to
+ * a power of two.
+ * @param hf A pointer to a hash function for mapping keys, or `NULL` to use
+ * the bundled hash_wyhash() with a random per-table seed.
+ * @return A pointer to the newly created hash table, or `NULL` on failure.
+ */
+concurrent_hash_table_t* concurrent_hash_table_create(size_t size,
+                                                      hash_function* hf);
+
+/**
+ * @brief Destroys the hash table and frees all associated memory. Objects
+ * stored in the hash table are not freed by this operation.
+ *
+ * No other thread may access the hash table during or after this call.
+ *
+ * @param ht The hash table to destroy.
+ */
+void concurrent_hash_table_destroy(concurrent_hash_table_t* ht);
+
+/**
+ * @brief Gets the number of entries stored in the hash table.
+ *
+ * @param ht The hash table.
+ * @return The number of entries, or 0 if the hash table is NULL.
+ */
+size_t concurrent_hash_table_size(concurrent_hash_table_t* ht);
+
+/**
+ * @brief Inserts a key-value pair into the hash table.
+ *
+ * @param ht The hash table.
+ * @param key The string key for the object.
+ * @param obj A pointer to the object to be stored.
+ * @return `true` if the insertion is successful, `false` if the key already
+ * exists, the arguments are invalid, or memory allocation fails.
+ */
+bool concurrent_hash_table_insert(concurrent_hash_table_t* ht, const char* key,
+                                  void* obj);
+
+/**
+ * @brief Looks up an object in the hash table by its key without taking any
+ * lock.
+ *
+ * @param ht The hash table.
+ * @param key The string key of the object to look up.
+ * @return A pointer to the object if found, `NULL` otherwise, including when
+ * the calling thread's reclamation state cannot be allocated on its first
+ * access to the table.
+ */
+void* concurrent_hash_table_lookup(concurrent_hash_table_t* ht,
+                                   const char* key);
+
+/**
+ * @brief Deletes an object from the hash table by its key.
+ *
+ * @param ht The hash table.
+ * @param key The string key of the object to delete.
+ * @return A pointer to the deleted object, or `NULL` if the key is not found
+ * or memory for the calling thread's reclamation state cannot be allocated.
+ */
+void* concurrent_hash_table_delete(concurrent_hash_table_t* ht,
+                                   const char* key);
+
+#endif // CONCURRENTHASHTABLE_H
@@ -0,0 +1,62 @@
+/**
+ * @file concurrentqueue.h
+ * @brief Header file for a lock-free multi-producer, multi-consumer queue
+ * implementation in C.
+ *
+ * The queue has the same semantics as using linked_list_push_back() and
+ * linked_list_pop_front() on a `linked_list_t`, but can be shared between any
+ * number of producer and consumer threads without external locking. It is a
+ * Michael-Scott queue: producers and consumers only synchronize through
+ * compare-and-swap on the tail and head pointers respectively, and dequeued
+ * nodes are reclaimed with epoch-based reclamation once no thread can still
+ * be reading them.
+ */
+
+#ifndef CONCURRENTQUEUE_H
+#define CONCURRENTQUEUE_H
+
+#include <stdbool.h>
+#include <stdlib.h>
+
+/** @brief Opaque structure representing a concurrent queue. */
+typedef struct _concurrent_queue concurrent_queue_t;
+
+/**
+ * @brief Creates a new concurrent queue.
+ *
+ * @return A pointer to the created queue, or NULL on failure.
+ */
+concurrent_queue_t* concurrent_queue_create();
+
+/**
+ * @brief Destroys the queue and optionally frees the objects still stored in
+ * it.
+ *
+ * No other thread may access the queue during or after this call.
+ *
+ * @param q Pointer to the queue to destroy.
+ * @param free_func Function pointer to a function that frees the objects in the
+ * queue. If NULL, the objects are not freed.
+ */
+void concurrent_queue_destroy(concurrent_queue_t* q, void (*free_func)(void*));
+
+/**
+ * @brief Adds an object to the back of the queue.
+ *
+ * @param q Pointer to the queue.
+ * @param obj Pointer to the object to add.
+ * @return True on success, false on failure.
+ */
+bool concurrent_queue_push_back(concurrent_queue_t* q, void* obj);
+
+/**
+ * @brief Removes and retrieves the object at the front of the queue.
+ *
+ * @param q Pointer to the queue.
+ * @return A pointer to the removed object, or NULL if the queue is empty or
+ * NULL, or if memory for the calling thread's reclamation state cannot be
+ * allocated on its first access to the queue.
+ */
+void* concurrent_queue_pop_front(concurrent_queue_t* q);
+
+#endif // CONCURRENTQUEUE_H
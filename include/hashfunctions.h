@@ -0,0 +1,37 @@
+/**
+ * @file hashfunctions.h
+ * @brief Header file for the hash functions bundled with the library.
+ *
+ * The hash functions are seeded, so that keys chosen by an attacker cannot be
+ * crafted to collide without knowing the seed, and process 16 to 48 bytes per
+ * iteration using 64x64->128 bit multiplications, which keeps them fast on
+ * long keys.
+ */
+
+#ifndef HASHFUNCTIONS_H
+#define HASHFUNCTIONS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Hashes a sequence of bytes with the wyhash algorithm.
+ *
+ * @param key The bytes to be hashed. May contain NUL bytes.
+ * @param len The number of bytes to hash.
+ * @param seed The seed selecting one hash function out of the family.
+ * @return The hashed value as a uint64_t.
+ */
+uint64_t hash_wyhash(const void* key, size_t len, uint64_t seed);
+
+/**
+ * @brief Generates a random seed for the bundled hash functions.
+ *
+ * The seed comes from the operating system's random number generator when
+ * available.
+ *
+ * @return A random uint64_t seed.
+ */
+uint64_t hash_random_seed(void);
+
+#endif // HASHFUNCTIONS_H
@@ -0,0 +1,344 @@
+/**
+ * @file hashmap.h
+ * @brief Macros generating type-specialized hash maps with fixed-size keys.
+ *
+ * `hash_table_t` stores string keys and `void*` objects. For keys of a fixed
+ * size, such as 64-bit IDs, DEFINE_HASH_MAP() generates a map storing keys and
+ * values inline, with hashing and key comparison specialized for the key type
+ * and inlined at compile time. No key is converted, copied into a separate
+ * allocation or hashed through a function pointer.
+ *
+ * @code
+ * DEFINE_HASH_MAP(u64_map, uint64_t, double)
+ *
+ * u64_map_t* map = u64_map_create(0);
+ * u64_map_insert(map, 42, 1.5);
+ * double* value = u64_map_lookup(map, 42);
+ * u64_map_destroy(map);
+ * @endcode
+ *
+ * The generated functions, all prefixed with the map name, are:
+ * - `name_t* name_create(size_t size)`
+ * - `name_t* name_create_with_allocator(size_t size, const allocator_t* a)`
+ * - `void name_destroy(name_t* map)`
+ * - `size_t name_size(const name_t* map)`
+ * - `bool name_insert(name_t* map, K key, V value)`
+ * - `V* name_lookup(name_t* map, K key)`
+ * - `V* name_emplace(name_t* map, K key, bool* inserted)`
+ * - `bool name_delete(name_t* map, K key, V* value)`
+ *
+ * Pointers to values are only valid until the next insertion or deletion.
+ * Maps are not thread-safe.
+ */
+
+#ifndef HASHMAP_H
+#define HASHMAP_H
+
+#include "allocator.h"
+#include "hashfunctions.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Slots hold a control byte: 0 when empty, otherwise the high bit set and the
+// top 7 bits of the key's hash, compared before the key itself
+#define HASH_MAP_EMPTY ((uint8_t)0)
+#define HASH_MAP_MIN_CAPACITY 8
+
+static inline void* hash_map_malloc(void* context, size_t size) {
+    (void)context;
+    return malloc(size);
+}
+
+static inline void hash_map_malloc_free(void* context, void* ptr,
+                                        size_t size) {
+    (void)context;
+    (void)size;
+    free(ptr);
+}
+
+static inline allocator_t hash_map_allocator(const allocator_t* allocator) {
+    if (allocator != NULL) {
+        return *allocator;
+    }
+    allocator_t result = {hash_map_malloc, hash_map_malloc_free, NULL};
+    return result;
+}
+
+static inline void hash_map_free(const allocator_t* allocator, void* ptr,
+                                 size_t size) {
+    if (ptr != NULL) {
+        allocator->free(allocator->context, ptr, size);
+    }
+}
+
+static inline uint8_t hash_map_tag(uint64_t hash) {
+    return (uint8_t)(0x80 | (hash >> 57));
+}
+
+// Number of slots keeping `size` keys at most 3/4 full, or 0 if it does not
+// fit in a size_t
+static inline size_t hash_map_capacity(size_t size) {
+    size_t capacity = HASH_MAP_MIN_CAPACITY;
+    while (capacity / 4 * 3 < size) {
+        if (capacity > SIZE_MAX >> 1) {
+            return 0;
+        }
+        capacity <<= 1;
+    }
+    return capacity;
+}
+
+/**
+ * @brief Default hash of a fixed-size key. Keys of 4 and 8 bytes are mixed
+ * with a few multiplications; `size` is a compile-time constant in the
+ * generated maps, so the other branches are removed.
+ */
+static inline uint64_t hash_map_hash_bytes(const void* key, size_t size,
+                                           uint64_t seed) {
+    uint64_t h;
+    if (size == sizeof(uint64_t)) {
+        memcpy(&h, key, sizeof(h));
+    } else if (size == sizeof(uint32_t)) {
+        uint32_t k;
+        memcpy(&k, key, sizeof(k));
+        h = k;
+    } else {
+        return hash_wyhash(key, size, seed);
+    }
+    h ^= seed;
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return h;
+}
+
+/**
+ * @brief Generates a hash map type `name_t` mapping keys of type `K` to
+ * values of type `V`, and its functions.
+ *
+ * Keys are hashed and compared by their bytes, so key types with padding must
+ * have it zeroed; use DEFINE_HASH_MAP_CUSTOM() otherwise.
+ *
+ * @param name Prefix of the generated type and functions.
+ * @param K Key type.
+ * @param V Value type.
+ */
+#define DEFINE_HASH_MAP(name, K, V)                                            \
+    static inline uint64_t name##_hash_key(K key, uint64_t seed) {             \
+        return hash_map_hash_bytes(&key, sizeof(K), seed);                     \
+    }                                                                          \
+    static inline bool name##_equal_keys(K a, K b) {                           \
+        return memcmp(&a, &b, sizeof(K)) == 0;                                 \
+    }                                                                          \
+    DEFINE_HASH_MAP_CUSTOM(name, K, V, name##_hash_key, name##_equal_keys)
+
+/**
+ * @brief Generates a hash map like DEFINE_HASH_MAP() with user-provided key
+ * hashing and comparison, typically static inline functions.
+ *
+ * @param name Prefix of the generated type and functions.
+ * @param K Key type.
+ * @param V Value type.
+ * @param hash_key Function `uint64_t hash_key(K key, uint64_t seed)` whose
+ * low and high bits are both well distributed.
+ * @param equal_keys Function `bool equal_keys(K a, K b)`.
+ */
+#define DEFINE_HASH_MAP_CUSTOM(name, K, V, hash_key, equal_keys)               \
+    typedef struct {                                                           \
+        K key;                                                                 \
+        V value;                                                               \
+    } name##_slot_t;                                                           \
+                                                                               \
+    /* Members are private */                                                  \
+    typedef struct {                                                           \
+        size_t capacity;                                                       \
+        size_t min_capacity;                                                   \
+        size_t count;                                                          \
+        uint64_t seed;                                                         \
+        uint8_t* ctrl;                                                         \
+        name##_slot_t* slots;                                                  \
+        allocator_t allocator;                                                 \
+    } name##_t;                                                                \
+                                                                               \
+    /* Moves every key into new arrays of `capacity` slots */                  \
+    static inline bool name##_rehash(name##_t* map, size_t capacity) {         \
+        if (capacity == 0 || capacity > SIZE_MAX / sizeof(name##_slot_t)) {    \
+            return false;                                                      \
+        }                                                                      \
+        uint8_t* ctrl =                                                        \
+            map->allocator.alloc(map->allocator.context, capacity);            \
+        name##_slot_t* slots = map->allocator.alloc(                           \
+            map->allocator.context, capacity * sizeof(name##_slot_t));         \
+        if (ctrl == NULL || slots == NULL) {                                   \
+            hash_map_free(&map->allocator, ctrl, capacity);                    \
+            hash_map_free(&map->allocator, slots,                              \
+                          capacity * sizeof(name##_slot_t));                   \
+            return false;                                                      \
+        }                                                                      \
+        memset(ctrl, HASH_MAP_EMPTY, capacity);                                \
+        size_t mask = capacity - 1;                                            \
+        for (size_t i = 0; i < map->capacity; i++) {                           \
+            if (map->ctrl[i] == HASH_MAP_EMPTY) {                              \
+                continue;                                                      \
+            }                                                                  \
+            size_t j = hash_key(map->slots[i].key, map->seed) & mask;          \
+            while (ctrl[j] != HASH_MAP_EMPTY) {                                \
+                j = (j + 1) & mask;                                            \
+            }                                                                  \
+            ctrl[j] = map->ctrl[i];                                            \
+            slots[j] = map->slots[i];                                          \
+        }                                                                      \
+        hash_map_free(&map->allocator, map->ctrl, map->capacity);              \
+        hash_map_free(&map->allocator, map->slots,                             \
+                      map->capacity * sizeof(name##_slot_t));                  \
+        map->ctrl = ctrl;                                                      \
+        map->slots = slots;                                                    \
+        map->capacity = capacity;                                              \
+        return true;                                                           \
+    }                                                                          \
+                                                                               \
+    static inline name##_t* name##_create_with_allocator(                      \
+        size_t size, const allocator_t* allocator) {                           \
+        allocator_t resolved = hash_map_allocator(allocator);                  \
+        name##_t* map = resolved.alloc(resolved.context, sizeof(*map));        \
+        if (map == NULL) {                                                     \
+            return NULL;                                                       \
+        }                                                                      \
+        map->capacity = 0;                                                     \
+        map->min_capacity = hash_map_capacity(size);                           \
+        map->count = 0;                                                        \
+        map->seed = hash_random_seed();                                        \
+        map->ctrl = NULL;                                                      \
+        map->slots = NULL;                                                     \
+        map->allocator = resolved;                                             \
+        if (!name##_rehash(map, map->min_capacity)) {                          \
+            hash_map_free(&resolved, map, sizeof(*map));                       \
+            return NULL;                                                       \
+        }                                                                      \
+        return map;                                                            \
+    }                                                                          \
+                                                                               \
+    static inline name##_t* name##_create(size_t size) {                       \
+        return name##_create_with_allocator(size, NULL);                       \
+    }                                                                          \
+                                                                               \
+    static inline void name##_destroy(name##_t* map) {                         \
+        if (map == NULL) {                                                     \
+            return;                                                            \
+        }                                                                      \
+        allocator_t allocator = map->allocator;                                \
+        hash_map_free(&allocator, map->ctrl, map->capacity);                   \
+        hash_map_free(&allocator, map->slots,                                  \
+                      map->capacity * sizeof(name##_slot_t));                  \
+        hash_map_free(&allocator, map, sizeof(*map));                          \
+    }                                                                          \
+                                                                               \
+    static inline size_t name##_size(const name##_t* map) {                    \
+        return map == NULL ? 0 : map->count;                                   \
+    }                                                                          \
+                                                                               \
+    /* Returns the slot holding `key`, or `map->capacity` if there is none */  \
+    static inline size_t name##_find(const name##_t* map, K key,               \
+                                     uint64_t hash) {                          \
+        uint8_t tag = hash_map_tag(hash);                                      \
+        size_t mask = map->capacity - 1;                                       \
+        for (size_t i = hash & mask;; i = (i + 1) & mask) {                    \
+            uint8_t c = map->ctrl[i];                                          \
+            if (c == tag && equal_keys(map->slots[i].key, key)) {              \
+                return i;                                                      \
+            }                                                                  \
+            if (c == HASH_MAP_EMPTY) {                                         \
+                return map->capacity;                                          \
+            }                                                                  \
+        }                                                                      \
+    }                                                                          \
+                                                                               \
+    static inline V* name##_lookup(name##_t* map, K key) {                     \
+        if (map == NULL) {                                                     \
+            return NULL;                                                       \
+        }                                                                      \
+        size_t i = name##_find(map, key, hash_key(key, map->seed));            \
+        return i == map->capacity ? NULL : &map->slots[i].value;               \
+    }                                                                          \
+                                                                               \
+    /* New values are zero-initialized */                                      \
+    static inline V* name##_emplace(name##_t* map, K key, bool* inserted) {    \
+        if (map == NULL) {                                                     \
+            return NULL;                                                       \
+        }                                                                      \
+        uint64_t hash = hash_key(key, map->seed);                              \
+        size_t i = name##_find(map, key, hash);                                \
+        if (i != map->capacity) {                                              \
+            *inserted = false;                                                 \
+            return &map->slots[i].value;                                       \
+        }                                                                      \
+        if (map->count + 1 > map->capacity / 4 * 3 &&                          \
+            !name##_rehash(map, map->capacity * 2)) {                          \
+            return NULL;                                                       \
+        }                                                                      \
+        size_t mask = map->capacity - 1;                                       \
+        i = hash & mask;                                                       \
+        while (map->ctrl[i] != HASH_MAP_EMPTY) {                               \
+            i = (i + 1) & mask;                                                \
+        }                                                                      \
+        map->ctrl[i] = hash_map_tag(hash);                                     \
+        map->slots[i].key = key;                                               \
+        memset(&map->slots[i].value, 0, sizeof(V));                            \
+        map->count += 1;                                                       \
+        *inserted = true;                                                      \
+        return &map->slots[i].value;                                           \
+    }                                                                          \
+                                                                               \
+    /* Does not overwrite the value of a key that is already present */        \
+    static inline bool name##_insert(name##_t* map, K key, V value) {          \
+        bool inserted;                                                         \
+        V* slot = name##_emplace(map, key, &inserted);                         \
+        if (slot == NULL || !inserted) {                                       \
+            return false;                                                      \
+        }                                                                      \
+        *slot = value;                                                         \
+        return true;                                                           \
+    }                                                                          \
+                                                                               \
+    /* Stores the removed value into `value` unless it is NULL. Keys after */  \
+    /* the removed one are shifted back, so no tombstones are left behind */   \
+    static inline bool name##_delete(name##_t* map, K key, V* value) {         \
+        if (map == NULL) {                                                     \
+            return false;                                                      \
+        }                                                                      \
+        size_t hole = name##_find(map, key, hash_key(key, map->seed));         \
+        if (hole == map->capacity) {                                           \
+            return false;                                                      \
+        }                                                                      \
+        if (value != NULL) {                                                   \
+            *value = map->slots[hole].value;                                   \
+        }                                                                      \
+        size_t mask = map->capacity - 1;                                       \
+        for (size_t j = (hole + 1) & mask; map->ctrl[j] != HASH_MAP_EMPTY;     \
+             j = (j + 1) & mask) {                                             \
+            size_t home = hash_key(map->slots[j].key, map->seed) & mask;       \
+            /* Move the key unless the hole precedes its home slot */          \
+            if (((j - home) & mask) >= ((j - hole) & mask)) {                  \
+                map->ctrl[hole] = map->ctrl[j];                                \
+                map->slots[hole] = map->slots[j];                              \
+                hole = j;                                                      \
+            }                                                                  \
+        }                                                                      \
+        map->ctrl[hole] = HASH_MAP_EMPTY;                                      \
+        map->count -= 1;                                                       \
+        /* Give memory back after mass deletions; failing to is harmless */    \
+        if (map->capacity > map->min_capacity &&                               \
+            map->count < map->capacity / 8) {                                  \
+            size_t capacity = hash_map_capacity(map->count * 2);               \
+            name##_rehash(map, capacity > map->min_capacity                    \
+                                   ? capacity                                  \
+                                   : map->min_capacity);                       \
+        }                                                                      \
+        return true;                                                           \
+    }
+
+#endif // HASHMAP_H
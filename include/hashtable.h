@@ -3,13 +3,19 @@
  * @brief Header file for a generic hash table implementation in C.
  *
  * This hash table allows the insertion, lookup, and deletion of key-value
- * pairs, with string keys and generic object values (`void*`). It uses separate
- * chaining for collision resolution.
+ * pairs, with string or binary keys and generic object values (`void*`). By
+ * default it uses separate chaining for collision resolution; an open
+ * addressing engine with SIMD-probed control bytes can be selected at creation
+ * time. The table tracks its load factor and resizes itself, migrating entries
+ * incrementally over subsequent operations so that no single call pays for a
+ * full rehash. Entries and keys are carved out of large chunks owned by the
+ * table.
  */
 
 #ifndef HASHTABLE_H
 #define HASHTABLE_H
 
+#include "allocator.h"
 #include <stdbool.h>
 #include <stdint.h>
 #include <stdlib.h>
@@ -24,29 +30,175 @@
  */
 typedef uint64_t hash_function(const char* key);
 
+/**
+ * @typedef hash_function_n
+ * @brief Defines a hash function that maps a key of explicit length to a
+ * uint64_t value. The key is not required to be NUL-terminated and may contain
+ * NUL bytes.
+ *
+ * @param key The key to be hashed.
+ * @param len The length of the key in bytes.
+ * @return The hashed value as a uint64_t.
+ */
+typedef uint64_t hash_function_n(const void* key, size_t len);
+
+/**
+ * @enum hash_table_engine_t
+ * @brief Collision resolution strategies available for a hash table.
+ */
+typedef enum {
+    /** Separate chaining with incremental rehashing. */
+    HASH_TABLE_CHAINING,
+    /**
+     * Open addressing with one control byte per slot holding 7 bits of the
+     * hash, probed 16 slots at a time (Swiss table layout).
+     */
+    HASH_TABLE_OPEN_ADDRESSING,
+} hash_table_engine_t;
+
 /**
  * @struct _hash_table
  * @brief Opaque structure representing a hash table.
  */
 typedef struct _hash_table hash_table_t;
 
+/** Number of bins in the chain length histogram of hash_table_stats_t. */
+#define HASH_TABLE_HISTOGRAM_SIZE 16
+
+/**
+ * @struct hash_table_stats_t
+ * @brief Snapshot of the state of a hash table, filled by hash_table_stats().
+ */
+typedef struct {
+    /** Number of entries stored in the table. */
+    size_t count;
+    /** Number of buckets (chaining) or slots (open addressing). */
+    size_t buckets;
+    /** Ratio of entries to buckets. */
+    double load_factor;
+    /**
+     * Chaining: `chain_histogram[i]` is the number of buckets holding `i`
+     * entries. Open addressing: the number of entries found after probing
+     * `i` groups of 16 slots. The last bin also counts all longer chains.
+     */
+    size_t chain_histogram[HASH_TABLE_HISTOGRAM_SIZE];
+    /** Length of the longest chain, or longest probe sequence in groups. */
+    size_t max_chain;
+    /** Bytes of memory allocated by the table, excluding stored objects. */
+    size_t bytes_allocated;
+    /**
+     * Whether the cumulative counters below are collected. They are only
+     * compiled in when the library is built with `HASH_TABLE_STATS` defined.
+     */
+    bool counters_enabled;
+    /** Number of keys looked up through the lookup functions. */
+    uint64_t lookups;
+    /** Number of looked up keys that were found. */
+    uint64_t hits;
+    /** Number of looked up keys that were not found. */
+    uint64_t misses;
+    /**
+     * Average number of entries compared (chaining) or groups probed (open
+     * addressing) per key search, including those done by insertions and
+     * deletions.
+     */
+    double avg_probes;
+} hash_table_stats_t;
+
 /**
  * @brief Creates a new hash table.
  *
- * @param size The number of buckets in the hash table.
- * @param hf A pointer to a hash function for mapping keys.
+ * The table grows when the number of stored entries exceeds the number of
+ * buckets and shrinks after mass deletions, but never below the initial size.
+ *
+ * @param size The initial number of buckets in the hash table, rounded up to
+ * a power of two.
+ * @param hf A pointer to a hash function for mapping keys, or `NULL` to use
+ * the bundled hash_wyhash() with a random per-table seed.
  * @return A pointer to the newly created hash table.
  */
 hash_table_t* hash_table_create(size_t size, hash_function* hf);
 
 /**
- * @brief Destroys the hash table and frees all associated memory. Objects
- * stored in the hash table are not freed by this operation.
+ * @brief Creates a new hash table using the given collision resolution engine.
+ *
+ * @param size The initial number of buckets (or slots for open addressing) in
+ * the hash table, rounded up to a power of two.
+ * @param hf A pointer to a hash function for mapping keys, or `NULL` to use
+ * the bundled hash_wyhash() with a random per-table seed.
+ * @param engine The collision resolution engine to use.
+ * @return A pointer to the newly created hash table, or `NULL` on failure.
+ */
+hash_table_t* hash_table_create_with_engine(size_t size, hash_function* hf,
+                                            hash_table_engine_t engine);
+
+/**
+ * @brief Creates a new hash table using a length-aware hash function.
+ *
+ * Tables created with a string `hash_function` also accept the `_n`
+ * operations, but have to copy each key into a NUL-terminated buffer before
+ * hashing it; this function avoids that copy.
+ *
+ * @param size The initial number of buckets (or slots for open addressing) in
+ * the hash table, rounded up to a power of two.
+ * @param hf A pointer to a length-aware hash function for mapping keys, or
+ * `NULL` to use the bundled hash_wyhash() with a random per-table seed.
+ * @param engine The collision resolution engine to use.
+ * @return A pointer to the newly created hash table, or `NULL` on failure.
+ */
+hash_table_t* hash_table_create_n(size_t size, hash_function_n* hf,
+                                  hash_table_engine_t engine);
+
+/**
+ * @brief Creates a new hash table that obtains all of its memory from the
+ * given allocator.
+ *
+ * The table structure, its bucket or slot arrays, entries and key copies are
+ * all allocated through `allocator`, and freed through it when the table
+ * shrinks, grows or is destroyed.
+ *
+ * @param size The initial number of buckets (or slots for open addressing) in
+ * the hash table, rounded up to a power of two.
+ * @param hf A pointer to a hash function for mapping keys, or `NULL` to use
+ * the bundled hash_wyhash() with a random per-table seed.
+ * @param engine The collision resolution engine to use.
+ * @param allocator The allocator to use, copied into the table, or `NULL` for
+ * malloc() and free().
+ * @return A pointer to the newly created hash table, or `NULL` on failure.
+ */
+hash_table_t* hash_table_create_with_allocator(size_t size, hash_function* hf,
+                                               hash_table_engine_t engine,
+                                               const allocator_t* allocator);
+
+/**
+ * @brief Destroys the hash table and frees all associated memory, including
+ * the copies of the keys. Objects stored in the hash table are not freed by
+ * this operation.
  *
  * @param ht The hash table to destroy.
  */
 void hash_table_destroy(hash_table_t* ht);
 
+/**
+ * @brief Gets the number of entries stored in the hash table.
+ *
+ * @param ht The hash table.
+ * @return The number of entries, or 0 if the hash table is NULL.
+ */
+size_t hash_table_size(hash_table_t* ht);
+
+/**
+ * @brief Collects statistics about the hash table.
+ *
+ * Computing the chain length histogram visits every bucket, so this function
+ * is meant for periodic monitoring rather than hot paths.
+ *
+ * @param ht The hash table.
+ * @param out Receives the statistics.
+ * @return `true` on success, `false` if any argument is NULL.
+ */
+bool hash_table_stats(hash_table_t* ht, hash_table_stats_t* out);
+
 /**
  * @brief Inserts a key-value pair into the hash table.
  *
@@ -57,6 +209,19 @@ void hash_table_destroy(hash_table_t* ht);
  */
 bool hash_table_insert(hash_table_t* ht, const char* key, void* obj);
 
+/**
+ * @brief Inserts a key-value pair into the hash table, where the key is a
+ * sequence of `len` bytes that may contain NUL bytes.
+ *
+ * @param ht The hash table.
+ * @param key The key bytes for the object.
+ * @param len The length of the key in bytes.
+ * @param obj A pointer to the object to be stored.
+ * @return `true` if the insertion is successful, `false` otherwise.
+ */
+bool hash_table_insert_n(hash_table_t* ht, const void* key, size_t len,
+                         void* obj);
+
 /**
  * @brief Looks up an object in the hash table by its key.
  *
@@ -66,6 +231,47 @@ bool hash_table_insert(hash_table_t* ht, const char* key, void* obj);
  */
 void* hash_table_lookup(hash_table_t* ht, const char* key);
 
+/**
+ * @brief Looks up an object in the hash table by a key of explicit length.
+ *
+ * The key is read in place, so it can point straight into a larger buffer.
+ *
+ * @param ht The hash table.
+ * @param key The key bytes of the object to look up.
+ * @param len The length of the key in bytes.
+ * @return A pointer to the object if found, `NULL` otherwise.
+ */
+void* hash_table_lookup_n(hash_table_t* ht, const void* key, size_t len);
+
+/**
+ * @brief Looks up several keys at once.
+ *
+ * All keys are hashed and their buckets prefetched before any of them is
+ * resolved, which hides memory latency across the independent lookups. This
+ * pays off for batches of dozens of keys on tables larger than the cache.
+ *
+ * @param ht The hash table.
+ * @param keys The string keys to look up.
+ * @param n The number of keys.
+ * @param out Receives, for each key, a pointer to its object if found, `NULL`
+ * otherwise. Must have room for `n` pointers.
+ */
+void hash_table_lookup_batch(hash_table_t* ht, const char* const* keys,
+                             size_t n, void** out);
+
+/**
+ * @brief Length-delimited variant of hash_table_lookup_batch().
+ *
+ * @param ht The hash table.
+ * @param keys The keys to look up.
+ * @param lens The length in bytes of each key.
+ * @param n The number of keys.
+ * @param out Receives, for each key, a pointer to its object if found, `NULL`
+ * otherwise. Must have room for `n` pointers.
+ */
+void hash_table_lookup_batch_n(hash_table_t* ht, const void* const* keys,
+                               const size_t* lens, size_t n, void** out);
+
 /**
  * @brief Deletes an object from the hash table by its key.
  *
@@ -75,4 +281,240 @@ void* hash_table_lookup(hash_table_t* ht, const char* key);
  */
 void* hash_table_delete(hash_table_t* ht, const char* key);
 
+/**
+ * @brief Deletes an object from the hash table by a key of explicit length.
+ *
+ * @param ht The hash table.
+ * @param key The key bytes of the object to delete.
+ * @param len The length of the key in bytes.
+ * @return A pointer to the deleted object, or `NULL` if the key is not found.
+ */
+void* hash_table_delete_n(hash_table_t* ht, const void* key, size_t len);
+
+/**
+ * @brief Returns the object stored under a key, inserting `obj` first if the
+ * key is not present. The table is probed only once.
+ *
+ * @param ht The hash table.
+ * @param key The string key for the object.
+ * @param obj A pointer to the object to insert if the key is absent.
+ * @return The object stored under the key after the call (the existing one,
+ * or `obj` if it was inserted), or `NULL` on failure.
+ */
+void* hash_table_get_or_insert(hash_table_t* ht, const char* key, void* obj);
+
+/**
+ * @brief Length-delimited variant of hash_table_get_or_insert().
+ *
+ * @param ht The hash table.
+ * @param key The key bytes for the object.
+ * @param len The length of the key in bytes.
+ * @param obj A pointer to the object to insert if the key is absent.
+ * @return The object stored under the key after the call, or `NULL` on
+ * failure.
+ */
+void* hash_table_get_or_insert_n(hash_table_t* ht, const void* key, size_t len,
+                                 void* obj);
+
+/**
+ * @brief Stores `obj` under a key, replacing any existing object. The table is
+ * probed only once.
+ *
+ * @param ht The hash table.
+ * @param key The string key for the object.
+ * @param obj A pointer to the object to be stored.
+ * @return The object previously stored under the key, or `NULL` if the key
+ * was not present or the insertion failed.
+ */
+void* hash_table_upsert(hash_table_t* ht, const char* key, void* obj);
+
+/**
+ * @brief Length-delimited variant of hash_table_upsert().
+ *
+ * @param ht The hash table.
+ * @param key The key bytes for the object.
+ * @param len The length of the key in bytes.
+ * @param obj A pointer to the object to be stored.
+ * @return The object previously stored under the key, or `NULL` if the key
+ * was not present or the insertion failed.
+ */
+void* hash_table_upsert_n(hash_table_t* ht, const void* key, size_t len,
+                          void* obj);
+
+/**
+ * @brief Finds or creates the entry for a key and returns a pointer to its
+ * object, so that the caller can read or write the value in place.
+ *
+ * If the key was absent, a new entry is created with a `NULL` object and
+ * `*inserted` is set to `true`; the caller must then store a non-NULL object
+ * through the returned pointer. The pointer is only valid until the next
+ * operation on the hash table.
+ *
+ * @param ht The hash table.
+ * @param key The string key for the object.
+ * @param inserted Set to whether a new entry was created.
+ * @return A pointer to the object stored under the key, or `NULL` on failure.
+ */
+void** hash_table_emplace(hash_table_t* ht, const char* key, bool* inserted);
+
+/**
+ * @brief Length-delimited variant of hash_table_emplace().
+ *
+ * @param ht The hash table.
+ * @param key The key bytes for the object.
+ * @param len The length of the key in bytes.
+ * @param inserted Set to whether a new entry was created.
+ * @return A pointer to the object stored under the key, or `NULL` on failure.
+ */
+void** hash_table_emplace_n(hash_table_t* ht, const void* key, size_t len,
+                            bool* inserted);
+
+/**
+ * @typedef hash_table_serializer
+ * @brief Defines a function exposing the bytes that represent an object in a
+ * snapshot file written by hash_table_save().
+ *
+ * @param object The object to serialize.
+ * @param size Receives the number of bytes, at most 4 GiB - 1.
+ * @return A pointer to the bytes, which must remain valid until the save
+ * completes, or `NULL` to abort the save.
+ */
+typedef const void* hash_table_serializer(const void* object, size_t* size);
+
+/**
+ * @struct _frozen_hash_table
+ * @brief Opaque structure representing an immutable snapshot of a hash table,
+ * created by hash_table_freeze().
+ */
+typedef struct _frozen_hash_table frozen_hash_table_t;
+
+/**
+ * @brief Builds a read-only, compact copy of a hash table for lookup-heavy
+ * data that no longer changes, such as dictionaries loaded at startup.
+ *
+ * The snapshot is indexed by a minimal perfect hash function (hash, displace
+ * and compress): each key maps to its own slot, so a lookup reads one
+ * displacement, one slot and compares one key, whether the key is present or
+ * not. The keys are packed back to back in a single buffer and each slot
+ * takes 16 bytes, plus under two bytes of displacements per key. Building
+ * takes time linear in the number of entries.
+ *
+ * The snapshot copies the keys and object pointers, is independent of the
+ * source table afterwards and obtains its memory from the source table's
+ * allocator. It can be read by any number of threads at once.
+ *
+ * @param ht The hash table to copy. It is not modified.
+ * @return A pointer to the frozen table, or `NULL` on failure or if the keys
+ * add up to 4 GiB or more.
+ */
+frozen_hash_table_t* hash_table_freeze(hash_table_t* ht);
+
+/**
+ * @brief Destroys a frozen hash table and its copies of the keys, or unmaps
+ * the file of a table opened with hash_table_open_mmap(). Objects are not
+ * freed by this operation.
+ *
+ * @param ft The frozen hash table to destroy.
+ */
+void frozen_hash_table_destroy(frozen_hash_table_t* ft);
+
+/**
+ * @brief Gets the number of entries stored in a frozen hash table.
+ *
+ * @param ft The frozen hash table.
+ * @return The number of entries, or 0 if the table is NULL.
+ */
+size_t frozen_hash_table_size(const frozen_hash_table_t* ft);
+
+/**
+ * @brief Gets the memory used by a frozen hash table, excluding the objects.
+ *
+ * @param ft The frozen hash table.
+ * @return The number of bytes, or 0 if the table is NULL.
+ */
+size_t frozen_hash_table_bytes(const frozen_hash_table_t* ft);
+
+/**
+ * @brief Looks up an object in a frozen hash table by its key.
+ *
+ * @param ft The frozen hash table.
+ * @param key The string key of the object to look up.
+ * @return A pointer to the object if found, `NULL` otherwise.
+ */
+void* frozen_hash_table_lookup(const frozen_hash_table_t* ft, const char* key);
+
+/**
+ * @brief Looks up an object in a frozen hash table by a key of explicit
+ * length.
+ *
+ * @param ft The frozen hash table.
+ * @param key The key bytes of the object to look up.
+ * @param len The length of the key in bytes.
+ * @return A pointer to the object if found, `NULL` otherwise.
+ */
+void* frozen_hash_table_lookup_n(const frozen_hash_table_t* ft,
+                                 const void* key, size_t len);
+
+/**
+ * @brief Looks up the value bytes stored under a key in a table opened with
+ * hash_table_open_mmap().
+ *
+ * @param ft The frozen hash table.
+ * @param key The key bytes of the value to look up.
+ * @param len The length of the key in bytes.
+ * @param size Receives the size of the value in bytes if found, or 0 for
+ * tables built by hash_table_freeze(). May be NULL.
+ * @return A pointer to the value, or to the object for tables built by
+ * hash_table_freeze(), if found; `NULL` otherwise.
+ */
+const void* frozen_hash_table_lookup_value(const frozen_hash_table_t* ft,
+                                           const void* key, size_t len,
+                                           size_t* size);
+
+/**
+ * @brief Writes a snapshot of a hash table to a file, in a layout that
+ * hash_table_open_mmap() serves lookups from without deserializing it.
+ *
+ * The file holds the frozen form of the table (see hash_table_freeze()),
+ * with each object replaced by the bytes `serialize` returns for it and
+ * offsets in place of pointers. It starts with a versioned header and a
+ * checksum of the whole file. It is written under a unique temporary name in
+ * the same directory and renamed to `path` once complete, so that readers
+ * never see a partial file, even while several processes save to the same
+ * path; the directory is then synced so that the replacement survives a
+ * crash. The file is created with mode 0666 minus the process umask, as read
+ * at the first save. The layout uses the native byte order.
+ *
+ * Records are addressed with 64-bit offsets, so unlike hash_table_freeze()
+ * the keys may add up to 4 GiB or more; each key and each serialized value
+ * must be under 4 GiB, and the table must hold fewer than 2^32 entries.
+ *
+ * @param ht The hash table to save. It is not modified.
+ * @param path The path of the file to create or replace.
+ * @param serialize A function returning the bytes of each object.
+ * @return `true` on success, `false` if any argument is NULL, `serialize`
+ * failed, or the file could not be written.
+ */
+bool hash_table_save(hash_table_t* ht, const char* path,
+                     hash_table_serializer* serialize);
+
+/**
+ * @brief Opens a snapshot written by hash_table_save() as a read-only frozen
+ * hash table backed by a memory mapping of the file.
+ *
+ * Lookups read the mapped file directly, so opening costs no allocation per
+ * entry and pages are shared between processes mapping the same file.
+ * Opening reads the whole file once to verify its checksum, then checks that
+ * every position, slot and record stays within the file. Lookup functions
+ * return pointers to the serialized values inside the mapping, which are
+ * 8-byte aligned, read-only and valid until the table is destroyed;
+ * frozen_hash_table_lookup_value() also reports their size.
+ *
+ * @param path The path of the snapshot file.
+ * @return A pointer to the frozen table, or `NULL` if the file cannot be
+ * mapped, was written by an incompatible version or on a machine of another
+ * byte order, is truncated, fails its checksum, or points outside itself.
+ */
+frozen_hash_table_t* hash_table_open_mmap(const char* path);
+
 #endif // HASHTABLE_H
@@ -0,0 +1,136 @@
+/**
+ * @file indexedlist.h
+ * @brief Header file for a generic indexed sequence implementation in C.
+ *
+ * An indexed list offers the same interface as `linked_list_t`, but is built
+ * as a skip list whose links record how many elements they skip over. Every
+ * positional operation (lookup, insert and delete by index) therefore runs in
+ * expected O(log n) time instead of walking the list element by element.
+ */
+
+#ifndef INDEXEDLIST_H
+#define INDEXEDLIST_H
+
+#include <stdbool.h>
+#include <stdlib.h>
+
+/** @brief Opaque structure representing an indexed list. */
+typedef struct _indexed_list indexed_list_t;
+
+/**
+ * @brief Creates a new indexed list.
+ *
+ * @return A pointer to the created list, or NULL on failure.
+ */
+indexed_list_t* indexed_list_create();
+
+/**
+ * @brief Destroys the list and optionally frees the objects stored in it.
+ *
+ * @param il Pointer to the list to destroy.
+ * @param free_func Function pointer to a function that frees the objects in the
+ * list. If NULL, the objects are not freed.
+ */
+void indexed_list_destroy(indexed_list_t* il, void (*free_func)(void*));
+
+/**
+ * @brief Gets the number of elements in the list.
+ *
+ * @param il Pointer to the list.
+ * @return The number of elements in the list, or 0 if the list is NULL.
+ */
+size_t indexed_list_size(indexed_list_t* il);
+
+/**
+ * @brief Adds an object to the front of the list.
+ *
+ * @param il Pointer to the list.
+ * @param obj Pointer to the object to add.
+ * @return True on success, false on failure.
+ */
+bool indexed_list_push_front(indexed_list_t* il, void* obj);
+
+/**
+ * @brief Adds an object to the back of the list.
+ *
+ * @param il Pointer to the list.
+ * @param obj Pointer to the object to add.
+ * @return True on success, false on failure.
+ */
+bool indexed_list_push_back(indexed_list_t* il, void* obj);
+
+/**
+ * @brief Retrieves the object at the front of the list without removing it.
+ *
+ * @param il Pointer to the list.
+ * @return A pointer to the object at the front, or NULL if the list is empty
+ * or NULL.
+ */
+void* indexed_list_peek_front(indexed_list_t* il);
+
+/**
+ * @brief Retrieves the object at the back of the list without removing it.
+ *
+ * @param il Pointer to the list.
+ * @return A pointer to the object at the back, or NULL if the list is empty
+ * or NULL.
+ */
+void* indexed_list_peek_back(indexed_list_t* il);
+
+/**
+ * @brief Removes and retrieves the object at the front of the list.
+ *
+ * @param il Pointer to the list.
+ * @return A pointer to the removed object, or NULL if the list is empty or
+ * NULL.
+ */
+void* indexed_list_pop_front(indexed_list_t* il);
+
+/**
+ * @brief Removes and retrieves the object at the back of the list.
+ *
+ * @param il Pointer to the list.
+ * @return A pointer to the removed object, or NULL if the list is empty or
+ * NULL.
+ */
+void* indexed_list_pop_back(indexed_list_t* il);
+
+/**
+ * @brief Retrieves the object at a specific index in the list in expected
+ * O(log n) time. The head's index is 0.
+ *
+ * @param il Pointer to the list.
+ * @param index The index of the desired object (0-based).
+ * @return A pointer to the object at the specified index, or NULL if the index
+ * is out of range or the list is NULL.
+ */
+void* indexed_list_lookup(indexed_list_t* il, size_t index);
+
+/**
+ * @brief Inserts an object at a specific index in the list in expected
+ * O(log n) time.
+ *
+ * The index must be in the range [0, size], where 0 adds to the front, and size
+ * adds to the back.
+ *
+ * @param il Pointer to the list.
+ * @param index The index where the object should be inserted (0-based).
+ * @param obj Pointer to the object to insert.
+ * @return True on success, false if the index is invalid.
+ */
+bool indexed_list_insert(indexed_list_t* il, size_t index, void* obj);
+
+/**
+ * @brief Deletes and retrieves the object at a specific index in the list in
+ * expected O(log n) time.
+ *
+ * The index must be in the range [0, size-1].
+ *
+ * @param il Pointer to the list.
+ * @param index The index of the object to delete (0-based).
+ * @return A pointer to the removed object, or NULL if the index is out of range
+ * or the list is NULL.
+ */
+void* indexed_list_delete(indexed_list_t* il, size_t index);
+
+#endif // INDEXEDLIST_H
@@ -0,0 +1,189 @@
+/**
+ * @file intrusivelist.h
+ * @brief Header file for an intrusive doubly linked list implementation in C.
+ *
+ * Unlike `linked_list_t`, an intrusive list never allocates: objects embed an
+ * `intrusive_link_t` member and the list links those members directly. The
+ * object is recovered from its link with intrusive_list_entry(). Pushing and
+ * removing objects cannot fail, and traversals reach the objects without an
+ * extra pointer hop.
+ *
+ * @code
+ * typedef struct {
+ *     int value;
+ *     intrusive_link_t link;
+ * } item_t;
+ *
+ * intrusive_list_t list;
+ * intrusive_list_init(&list);
+ * intrusive_list_push_back(&list, &item->link);
+ * intrusive_list_foreach(pos, &list) {
+ *     item_t* it = intrusive_list_entry(pos, item_t, link);
+ * }
+ * @endcode
+ */
+
+#ifndef INTRUSIVELIST_H
+#define INTRUSIVELIST_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * @brief Link embedded in objects stored in an intrusive list. A link belongs
+ * to at most one list at a time.
+ */
+typedef struct intrusive_link_t {
+    struct intrusive_link_t* next;
+    struct intrusive_link_t* prev;
+} intrusive_link_t;
+
+/**
+ * @brief Intrusive list, meant to be embedded or declared by the caller and
+ * initialized with intrusive_list_init(). It must not be copied or moved
+ * while it holds elements.
+ */
+typedef struct {
+    // Sentinel of the circular list of links
+    intrusive_link_t head;
+    size_t size;
+} intrusive_list_t;
+
+/**
+ * @brief Retrieves the object containing a link.
+ *
+ * @param link Pointer to the link.
+ * @param type Type of the object containing the link.
+ * @param member Name of the link member within `type`.
+ */
+#define intrusive_list_entry(link, type, member)                               \
+    ((type*)((char*)(link) - offsetof(type, member)))
+
+/**
+ * @brief Loops over the links of a list from front to back. The current link
+ * must not be removed inside the loop; use intrusive_list_next() before
+ * removing it instead.
+ *
+ * @param pos Name of the `intrusive_link_t*` loop variable.
+ * @param list Pointer to the list.
+ */
+#define intrusive_list_foreach(pos, list)                                      \
+    for (intrusive_link_t* pos = (list)->head.next; pos != &(list)->head;      \
+         pos = pos->next)
+
+/**
+ * @brief Initializes an empty list.
+ *
+ * @param list Pointer to the list.
+ */
+void intrusive_list_init(intrusive_list_t* list);
+
+/**
+ * @brief Gets the number of elements in the list.
+ *
+ * @param list Pointer to the list.
+ * @return The number of elements in the list, or 0 if the list is NULL.
+ */
+size_t intrusive_list_size(const intrusive_list_t* list);
+
+/**
+ * @brief Adds a link to the front of the list.
+ *
+ * @param list Pointer to the list.
+ * @param link Pointer to a link that is not in any list.
+ * @return True on success, false if an argument is NULL.
+ */
+bool intrusive_list_push_front(intrusive_list_t* list, intrusive_link_t* link);
+
+/**
+ * @brief Adds a link to the back of the list.
+ *
+ * @param list Pointer to the list.
+ * @param link Pointer to a link that is not in any list.
+ * @return True on success, false if an argument is NULL.
+ */
+bool intrusive_list_push_back(intrusive_list_t* list, intrusive_link_t* link);
+
+/**
+ * @brief Inserts a link right before another link of the list.
+ *
+ * @param list Pointer to the list.
+ * @param pos Pointer to a link of the list.
+ * @param link Pointer to a link that is not in any list.
+ * @return True on success, false if an argument is NULL.
+ */
+bool intrusive_list_insert_before(intrusive_list_t* list, intrusive_link_t* pos,
+                                  intrusive_link_t* link);
+
+/**
+ * @brief Inserts a link right after another link of the list.
+ *
+ * @param list Pointer to the list.
+ * @param pos Pointer to a link of the list.
+ * @param link Pointer to a link that is not in any list.
+ * @return True on success, false if an argument is NULL.
+ */
+bool intrusive_list_insert_after(intrusive_list_t* list, intrusive_link_t* pos,
+                                 intrusive_link_t* link);
+
+/**
+ * @brief Retrieves the link at the front of the list without removing it.
+ *
+ * @param list Pointer to the list.
+ * @return A pointer to the front link, or NULL if the list is empty or NULL.
+ */
+intrusive_link_t* intrusive_list_front(const intrusive_list_t* list);
+
+/**
+ * @brief Retrieves the link at the back of the list without removing it.
+ *
+ * @param list Pointer to the list.
+ * @return A pointer to the back link, or NULL if the list is empty or NULL.
+ */
+intrusive_link_t* intrusive_list_back(const intrusive_list_t* list);
+
+/**
+ * @brief Gets the link following another link of the list.
+ *
+ * @param list Pointer to the list.
+ * @param link Pointer to a link of the list.
+ * @return A pointer to the next link, or NULL if `link` is the back link.
+ */
+intrusive_link_t* intrusive_list_next(const intrusive_list_t* list,
+                                      const intrusive_link_t* link);
+
+/**
+ * @brief Gets the link preceding another link of the list.
+ *
+ * @param list Pointer to the list.
+ * @param link Pointer to a link of the list.
+ * @return A pointer to the previous link, or NULL if `link` is the front link.
+ */
+intrusive_link_t* intrusive_list_prev(const intrusive_list_t* list,
+                                      const intrusive_link_t* link);
+
+/**
+ * @brief Removes a link from the list in constant time.
+ *
+ * @param list Pointer to the list.
+ * @param link Pointer to a link of the list.
+ */
+void intrusive_list_remove(intrusive_list_t* list, intrusive_link_t* link);
+
+/**
+ * @brief Removes and retrieves the link at the front of the list.
+ *
+ * @param list Pointer to the list.
+ * @return A pointer to the removed link, or NULL if the list is empty or NULL.
+ */
+intrusive_link_t* intrusive_list_pop_front(intrusive_list_t* list);
+
+/**
+ * @brief Removes and retrieves the link at the back of the list.
+ *
+ * @param list Pointer to the list.
+ * @return A pointer to the removed link, or NULL if the list is empty or NULL.
+ */
+intrusive_link_t* intrusive_list_pop_back(intrusive_list_t* list);
+
+#endif // INTRUSIVELIST_H
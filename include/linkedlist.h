@@ -11,21 +11,108 @@
 #ifndef LINKEDLIST_H
 #define LINKEDLIST_H
 
+#include "allocator.h"
 #include <stdbool.h>
 #include <stdlib.h>
 
 /** @brief Opaque structure representing a linked list. */
 typedef struct _linked_list linked_list_t;
 
+/**
+ * @brief Function comparing two objects of a linked list.
+ *
+ * Unlike the comparison function of qsort(), it receives the objects
+ * themselves rather than pointers to them.
+ *
+ * @return A negative value if `a` orders before `b`, zero if they are
+ * equivalent, and a positive value if `a` orders after `b`.
+ */
+typedef int linked_list_compare(const void* a, const void* b);
+
+/**
+ * @brief Opaque structure representing a pool of list nodes.
+ *
+ * Nodes are carved out of large chunks and recycled through a free list when
+ * they are removed, so pushes and pops do not go through malloc() and free().
+ * A pool can be shared by several lists, but is not thread-safe.
+ */
+typedef struct _linked_list_pool linked_list_pool_t;
+
+/**
+ * @brief Position within a linked list, used to walk the list in order and
+ * edit it in place.
+ *
+ * A cursor either points at an element or is past the end of the list. It is
+ * a small value meant to live on the stack; its members are private. A cursor
+ * stays valid across edits made through it, but is invalidated when the
+ * element it points at is removed by any other means.
+ */
+typedef struct {
+    linked_list_t* list;
+    void* node;
+} linked_list_cursor_t;
+
 /**
  * @brief Creates a new linked list.
  *
- * Allocates and initializes a new linked list structure.
+ * Allocates and initializes a new linked list structure. The list draws its
+ * nodes from a private pool that is released when the list is destroyed.
  *
  * @return A pointer to the created linked list.
  */
 linked_list_t* linked_list_create();
 
+/**
+ * @brief Creates a node pool that can be shared between linked lists.
+ *
+ * @return A pointer to the created pool, or NULL on failure.
+ */
+linked_list_pool_t* linked_list_pool_create();
+
+/**
+ * @brief Creates a node pool that obtains its memory from the given
+ * allocator. Lists created with the pool are allocated through it too.
+ *
+ * @param allocator The allocator to use, copied into the pool, or NULL for
+ * malloc() and free().
+ * @return A pointer to the created pool, or NULL on failure.
+ */
+linked_list_pool_t*
+linked_list_pool_create_with_allocator(const allocator_t* allocator);
+
+/**
+ * @brief Destroys a node pool and releases all of its memory.
+ *
+ * Every list created with the pool must be destroyed first.
+ *
+ * @param pool Pointer to the pool to destroy.
+ */
+void linked_list_pool_destroy(linked_list_pool_t* pool);
+
+/**
+ * @brief Creates a new linked list that draws its nodes from a shared pool.
+ *
+ * Nodes freed by one list are reused by any list sharing the pool.
+ *
+ * @param pool Pointer to the pool, or NULL to give the list a private pool as
+ * linked_list_create() does.
+ * @return A pointer to the created linked list, or NULL on failure.
+ */
+linked_list_t* linked_list_create_with_pool(linked_list_pool_t* pool);
+
+/**
+ * @brief Creates a new linked list that obtains all of its memory from the
+ * given allocator.
+ *
+ * The list structure and its private node pool are allocated through
+ * `allocator`. linked_list_to_array() still returns memory from malloc().
+ *
+ * @param allocator The allocator to use, copied into the list, or NULL for
+ * malloc() and free().
+ * @return A pointer to the created linked list, or NULL on failure.
+ */
+linked_list_t* linked_list_create_with_allocator(const allocator_t* allocator);
+
 /**
  * @brief Destroys the linked list and optionally frees the objects stored in
  * it.
@@ -96,7 +183,8 @@ void* linked_list_peek_back(linked_list_t* ll);
 void* linked_list_pop_front(linked_list_t* ll);
 
 /**
- * @brief Removes and retrieves the object at the back of the linked list.
+ * @brief Removes and retrieves the object at the back of the linked list in
+ * constant time.
  *
  * @param ll Pointer to the linked list.
  * @return A pointer to the removed object, or NULL if the list is empty or
@@ -108,6 +196,8 @@ void* linked_list_pop_back(linked_list_t* ll);
  * @brief Retrieves the object at a specific index in the linked list, measured
  * from the head of the list. The head's index is 0.
  *
+ * The list is traversed from whichever end is closer to the index.
+ *
  * @param ll Pointer to the linked list.
  * @param index The index of the desired object (0-based).
  * @return A pointer to the object at the specified index, or NULL if the index
@@ -141,4 +231,167 @@ bool linked_list_insert(linked_list_t* ll, size_t index, void* obj);
  */
 void* linked_list_delete(linked_list_t* ll, size_t index);
 
+/**
+ * @brief Creates a cursor pointing at the front of the linked list.
+ *
+ * @param ll Pointer to the linked list.
+ * @return A cursor at the first element, or past the end if the list is empty.
+ */
+linked_list_cursor_t linked_list_cursor_front(linked_list_t* ll);
+
+/**
+ * @brief Creates a cursor pointing at the back of the linked list.
+ *
+ * @param ll Pointer to the linked list.
+ * @return A cursor at the last element, or past the end if the list is empty.
+ */
+linked_list_cursor_t linked_list_cursor_back(linked_list_t* ll);
+
+/**
+ * @brief Checks whether the cursor points at an element.
+ *
+ * @param cursor Pointer to the cursor.
+ * @return True if the cursor points at an element, false if it is past the
+ * end of the list or NULL.
+ */
+bool linked_list_cursor_valid(const linked_list_cursor_t* cursor);
+
+/**
+ * @brief Retrieves the object the cursor points at.
+ *
+ * @param cursor Pointer to the cursor.
+ * @return A pointer to the object, or NULL if the cursor is past the end.
+ */
+void* linked_list_cursor_get(const linked_list_cursor_t* cursor);
+
+/**
+ * @brief Moves the cursor to the next element, or past the end after the last
+ * one.
+ *
+ * @param cursor Pointer to the cursor.
+ */
+void linked_list_cursor_next(linked_list_cursor_t* cursor);
+
+/**
+ * @brief Moves the cursor to the previous element. Moving back from past the
+ * end lands on the last element, and moving back from the first element goes
+ * past the end.
+ *
+ * @param cursor Pointer to the cursor.
+ */
+void linked_list_cursor_prev(linked_list_cursor_t* cursor);
+
+/**
+ * @brief Inserts an object before the cursor in constant time. If the cursor
+ * is past the end, the object is added to the back of the list.
+ *
+ * The cursor keeps pointing at the same element.
+ *
+ * @param cursor Pointer to the cursor.
+ * @param obj Pointer to the object to insert.
+ * @return True on success, false on failure.
+ */
+bool linked_list_cursor_insert_before(linked_list_cursor_t* cursor,
+                                      void* obj);
+
+/**
+ * @brief Inserts an object after the cursor in constant time.
+ *
+ * The cursor keeps pointing at the same element.
+ *
+ * @param cursor Pointer to the cursor.
+ * @param obj Pointer to the object to insert.
+ * @return True on success, false if the cursor is past the end or on failure.
+ */
+bool linked_list_cursor_insert_after(linked_list_cursor_t* cursor, void* obj);
+
+/**
+ * @brief Removes the object at the cursor in constant time and moves the
+ * cursor to the next element.
+ *
+ * @param cursor Pointer to the cursor.
+ * @return A pointer to the removed object, or NULL if the cursor is past the
+ * end.
+ */
+void* linked_list_cursor_remove(linked_list_cursor_t* cursor);
+
+/**
+ * @brief Calls a function on every object of the linked list, from front to
+ * back.
+ *
+ * The function must not add or remove elements; use a cursor for that.
+ *
+ * @param ll Pointer to the linked list.
+ * @param func Function called with each object and `arg`.
+ * @param arg Argument passed through to every call of `func`.
+ */
+void linked_list_foreach(linked_list_t* ll, void (*func)(void*, void*),
+                         void* arg);
+
+/**
+ * @brief Moves all objects of one linked list to the back of another, leaving
+ * the source list empty.
+ *
+ * The nodes are relinked without being visited when both lists share a pool,
+ * or when the source list owns a private pool, whose chunks are then handed
+ * over to the destination. Otherwise the objects are copied in time linear in
+ * the size of the source list.
+ *
+ * @param dst Pointer to the linked list receiving the objects.
+ * @param src Pointer to the linked list to empty.
+ * @return True on success, false if a list is NULL, both are the same list, or
+ * memory could not be allocated.
+ */
+bool linked_list_splice(linked_list_t* dst, linked_list_t* src);
+
+/**
+ * @brief Adds several objects to the back of the linked list, in order.
+ *
+ * Either all objects are added or, on failure, the list is left unchanged.
+ *
+ * @param ll Pointer to the linked list.
+ * @param objs Array of pointers to the objects to add.
+ * @param n Number of objects in `objs`.
+ * @return True on success, false if an object is NULL or on failure.
+ */
+bool linked_list_push_back_many(linked_list_t* ll, void* const* objs,
+                                size_t n);
+
+/**
+ * @brief Copies the objects of the linked list, from front to back, into a
+ * newly allocated array.
+ *
+ * @param ll Pointer to the linked list.
+ * @return An array of linked_list_size() object pointers, to be released with
+ * free(), or NULL if the list is empty or NULL, or on failure.
+ */
+void** linked_list_to_array(linked_list_t* ll);
+
+/**
+ * @brief Sorts the linked list in place with a stable merge sort.
+ *
+ * Nodes are relinked rather than copied, so the sort allocates no memory and
+ * runs in O(n log n) time.
+ *
+ * @param ll Pointer to the linked list.
+ * @param cmp Function comparing two objects.
+ */
+void linked_list_sort(linked_list_t* ll, linked_list_compare* cmp);
+
+/**
+ * @brief Sorts the linked list in place with a stable merge sort spread over
+ * several threads.
+ *
+ * The list is cut into one sublist per thread, the sublists are sorted
+ * concurrently and then merged pairwise. Lists too short to benefit are
+ * sorted on the calling thread like linked_list_sort() does.
+ *
+ * @param ll Pointer to the linked list.
+ * @param cmp Function comparing two objects, called concurrently.
+ * @param num_threads Maximum number of threads to use, including the calling
+ * thread.
+ */
+void linked_list_sort_parallel(linked_list_t* ll, linked_list_compare* cmp,
+                               size_t num_threads);
+
 #endif // LINKEDLIST_H
@@ -0,0 +1,64 @@
+/**
+ * @file spscring.h
+ * @brief Header file for a bounded single-producer, single-consumer ring
+ * buffer implementation in C.
+ *
+ * The ring buffer passes objects from exactly one producer thread to exactly
+ * one consumer thread without locks or atomic read-modify-write operations.
+ * Its capacity is fixed at creation, which makes it suited to pipelines where
+ * back-pressure on the producer is desirable.
+ */
+
+#ifndef SPSCRING_H
+#define SPSCRING_H
+
+#include <stdbool.h>
+#include <stdlib.h>
+
+/** @brief Opaque structure representing a single-producer ring buffer. */
+typedef struct _spsc_ring spsc_ring_t;
+
+/**
+ * @brief Creates a new ring buffer.
+ *
+ * @param capacity The maximum number of objects the ring buffer holds, rounded
+ * up to a power of two.
+ * @return A pointer to the created ring buffer, or NULL on failure.
+ */
+spsc_ring_t* spsc_ring_create(size_t capacity);
+
+/**
+ * @brief Destroys the ring buffer and optionally frees the objects still
+ * stored in it.
+ *
+ * Neither the producer nor the consumer may access the ring buffer during or
+ * after this call.
+ *
+ * @param ring Pointer to the ring buffer to destroy.
+ * @param free_func Function pointer to a function that frees the objects in the
+ * ring buffer. If NULL, the objects are not freed.
+ */
+void spsc_ring_destroy(spsc_ring_t* ring, void (*free_func)(void*));
+
+/**
+ * @brief Adds an object to the back of the ring buffer. Must only be called by
+ * the producer thread.
+ *
+ * @param ring Pointer to the ring buffer.
+ * @param obj Pointer to the object to add.
+ * @return True on success, false if the ring buffer is full or the arguments
+ * are invalid.
+ */
+bool spsc_ring_push(spsc_ring_t* ring, void* obj);
+
+/**
+ * @brief Removes and retrieves the object at the front of the ring buffer.
+ * Must only be called by the consumer thread.
+ *
+ * @param ring Pointer to the ring buffer.
+ * @return A pointer to the removed object, or NULL if the ring buffer is empty
+ * or NULL.
+ */
+void* spsc_ring_pop(spsc_ring_t* ring);
+
+#endif // SPSCRING_H
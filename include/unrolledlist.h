@@ -0,0 +1,135 @@
+/**
+ * @file unrolledlist.h
+ * @brief Header file for a generic unrolled linked list implementation in C.
+ *
+ * An unrolled list offers the same interface as `linked_list_t`, but each node
+ * stores a small array of objects instead of a single one. Traversals touch
+ * one node per several elements, which makes indexed access and iteration
+ * considerably more cache friendly and lowers the memory overhead per element.
+ */
+
+#ifndef UNROLLEDLIST_H
+#define UNROLLEDLIST_H
+
+#include <stdbool.h>
+#include <stdlib.h>
+
+/** @brief Opaque structure representing an unrolled linked list. */
+typedef struct _unrolled_list unrolled_list_t;
+
+/**
+ * @brief Creates a new unrolled linked list.
+ *
+ * @return A pointer to the created list, or NULL on failure.
+ */
+unrolled_list_t* unrolled_list_create();
+
+/**
+ * @brief Destroys the list and optionally frees the objects stored in it.
+ *
+ * @param ul Pointer to the list to destroy.
+ * @param free_func Function pointer to a function that frees the objects in the
+ * list. If NULL, the objects are not freed.
+ */
+void unrolled_list_destroy(unrolled_list_t* ul, void (*free_func)(void*));
+
+/**
+ * @brief Gets the number of elements in the list.
+ *
+ * @param ul Pointer to the list.
+ * @return The number of elements in the list, or 0 if the list is NULL.
+ */
+size_t unrolled_list_size(unrolled_list_t* ul);
+
+/**
+ * @brief Adds an object to the front of the list.
+ *
+ * @param ul Pointer to the list.
+ * @param obj Pointer to the object to add.
+ * @return True on success, false on failure.
+ */
+bool unrolled_list_push_front(unrolled_list_t* ul, void* obj);
+
+/**
+ * @brief Adds an object to the back of the list.
+ *
+ * @param ul Pointer to the list.
+ * @param obj Pointer to the object to add.
+ * @return True on success, false on failure.
+ */
+bool unrolled_list_push_back(unrolled_list_t* ul, void* obj);
+
+/**
+ * @brief Retrieves the object at the front of the list without removing it.
+ *
+ * @param ul Pointer to the list.
+ * @return A pointer to the object at the front, or NULL if the list is empty
+ * or NULL.
+ */
+void* unrolled_list_peek_front(unrolled_list_t* ul);
+
+/**
+ * @brief Retrieves the object at the back of the list without removing it.
+ *
+ * @param ul Pointer to the list.
+ * @return A pointer to the object at the back, or NULL if the list is empty
+ * or NULL.
+ */
+void* unrolled_list_peek_back(unrolled_list_t* ul);
+
+/**
+ * @brief Removes and retrieves the object at the front of the list.
+ *
+ * @param ul Pointer to the list.
+ * @return A pointer to the removed object, or NULL if the list is empty or
+ * NULL.
+ */
+void* unrolled_list_pop_front(unrolled_list_t* ul);
+
+/**
+ * @brief Removes and retrieves the object at the back of the list.
+ *
+ * @param ul Pointer to the list.
+ * @return A pointer to the removed object, or NULL if the list is empty or
+ * NULL.
+ */
+void* unrolled_list_pop_back(unrolled_list_t* ul);
+
+/**
+ * @brief Retrieves the object at a specific index in the list, measured from
+ * the head of the list. The head's index is 0.
+ *
+ * @param ul Pointer to the list.
+ * @param index The index of the desired object (0-based).
+ * @return A pointer to the object at the specified index, or NULL if the index
+ * is out of range or the list is NULL.
+ */
+void* unrolled_list_lookup(unrolled_list_t* ul, size_t index);
+
+/**
+ * @brief Inserts an object at a specific index in the list.
+ *
+ * The index must be in the range [0, size], where 0 adds to the front, and size
+ * adds to the back. A full node is split in two to make room.
+ *
+ * @param ul Pointer to the list.
+ * @param index The index where the object should be inserted (0-based).
+ * @param obj Pointer to the object to insert.
+ * @return True on success, false if the index is invalid.
+ */
+bool unrolled_list_insert(unrolled_list_t* ul, size_t index, void* obj);
+
+/**
+ * @brief Deletes and retrieves the object at a specific index in the list.
+ *
+ * The index must be in the range [0, size-1]. A node that becomes less than
+ * half full is merged with its successor when both fit in one node.
+ *
+ * @param ul Pointer to the list.
+ * @param index The index of the object to delete (0-based).
+ * @return A pointer to the removed object, or NULL if the index is out of range
+ * or the list is NULL.
+ */
+void* unrolled_list_delete(unrolled_list_t* ul, size_t index);
+
+#endif // UNROLLEDLIST_H
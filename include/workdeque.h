@@ -0,0 +1,72 @@
+/**
+ * @file workdeque.h
+ * @brief Header file for a lock-free work-stealing deque implementation in C.
+ *
+ * A work-stealing deque (Chase-Lev) is owned by one thread, which pushes and
+ * pops objects at the bottom like a stack, while any number of other threads
+ * steal objects from the top. The owner never takes a lock and only needs an
+ * atomic read-modify-write operation when it races a thief for the last
+ * object. The deque grows its circular buffer as needed.
+ *
+ * This is the building block of work-stealing schedulers: each worker keeps
+ * its own tasks in a deque and idle workers steal from the others.
+ */
+
+#ifndef WORKDEQUE_H
+#define WORKDEQUE_H
+
+#include <stdbool.h>
+#include <stdlib.h>
+
+/** @brief Opaque structure representing a work-stealing deque. */
+typedef struct _work_deque work_deque_t;
+
+/**
+ * @brief Creates a new work-stealing deque.
+ *
+ * @param capacity The initial capacity of the deque, rounded up to a power of
+ * two. The deque grows beyond it when needed.
+ * @return A pointer to the created deque, or NULL on failure.
+ */
+work_deque_t* work_deque_create(size_t capacity);
+
+/**
+ * @brief Destroys the deque. Objects still stored in it are not freed.
+ *
+ * No other thread may access the deque during or after this call.
+ *
+ * @param dq Pointer to the deque to destroy.
+ */
+void work_deque_destroy(work_deque_t* dq);
+
+/**
+ * @brief Pushes an object at the bottom of the deque. Must only be called by
+ * the owner thread.
+ *
+ * @param dq Pointer to the deque.
+ * @param obj Pointer to the object to push.
+ * @return True on success, false if an argument is NULL or the buffer could
+ * not grow.
+ */
+bool work_deque_push(work_deque_t* dq, void* obj);
+
+/**
+ * @brief Pops the most recently pushed object from the bottom of the deque.
+ * Must only be called by the owner thread.
+ *
+ * @param dq Pointer to the deque.
+ * @return A pointer to the popped object, or NULL if the deque is empty.
+ */
+void* work_deque_pop(work_deque_t* dq);
+
+/**
+ * @brief Steals the least recently pushed object from the top of the deque.
+ * May be called by any thread.
+ *
+ * @param dq Pointer to the deque.
+ * @return A pointer to the stolen object, or NULL if the deque is empty or
+ * another thread took the object first.
+ */
+void* work_deque_steal(work_deque_t* dq);
+
+#endif // WORKDEQUE_H
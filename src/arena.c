@@ -0,0 +1,181 @@
+#include "arena.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Size of the chunks blocks are carved from. The first chunks are smaller so
+// that small containers stay small; sizes double up to ARENA_CHUNK_SIZE.
+#define ARENA_MIN_CHUNK_SIZE 1024
+#define ARENA_CHUNK_SIZE (64 * 1024)
+// Blocks larger than this get a dedicated chunk
+#define ARENA_LARGE_BLOCK (ARENA_CHUNK_SIZE / 4)
+
+struct arena_chunk_t {
+    struct arena_chunk_t* next;
+    size_t size;
+};
+
+typedef struct free_block_t {
+    struct free_block_t* next;
+} free_block_t;
+
+// Maps a block size to its size class and the rounded size of that class
+static size_t arena_class(size_t size, size_t* rounded) {
+    if (size <= ARENA_SMALL_MAX) {
+        size_t r = (size + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1);
+        if (r == 0) {
+            r = ARENA_ALIGN;
+        }
+        *rounded = r;
+        return r / ARENA_ALIGN - 1;
+    }
+    size_t r = ARENA_SMALL_MAX * 2;
+    size_t class = ARENA_SMALL_MAX / ARENA_ALIGN;
+    while (r < size) {
+        r <<= 1;
+        class += 1;
+    }
+    *rounded = r;
+    return class;
+}
+
+static void* malloc_alloc(void* context, size_t size) {
+    (void)context;
+    return malloc(size);
+}
+
+static void malloc_free(void* context, void* ptr, size_t size) {
+    (void)context;
+    (void)size;
+    free(ptr);
+}
+
+bool allocator_equal(const allocator_t* a, const allocator_t* b) {
+    return a->alloc == b->alloc && a->free == b->free &&
+           a->context == b->context;
+}
+
+void* allocator_alloc(const allocator_t* allocator, size_t size) {
+    return allocator->alloc(allocator->context, size);
+}
+
+void* allocator_calloc(const allocator_t* allocator, size_t n, size_t size) {
+    if (size != 0 && n > SIZE_MAX / size) {
+        return NULL;
+    }
+    void* ptr = allocator_alloc(allocator, n * size);
+    if (ptr != NULL) {
+        memset(ptr, 0, n * size);
+    }
+    return ptr;
+}
+
+void allocator_free(const allocator_t* allocator, void* ptr, size_t size) {
+    if (ptr != NULL) {
+        allocator->free(allocator->context, ptr, size);
+    }
+}
+
+static arena_chunk_t* arena_new_chunk(arena_t* arena, size_t size) {
+    arena_chunk_t* chunk =
+        allocator_alloc(&arena->allocator, sizeof(*chunk) + size);
+    if (chunk == NULL) {
+        return NULL;
+    }
+    chunk->size = size;
+    chunk->next = arena->chunks;
+    arena->chunks = chunk;
+    arena->bytes += sizeof(*chunk) + size;
+    return chunk;
+}
+
+void arena_init(arena_t* arena, const allocator_t* allocator) {
+    memset(arena, 0, sizeof(*arena));
+    if (allocator != NULL) {
+        arena->allocator = *allocator;
+    } else {
+        arena->allocator.alloc = malloc_alloc;
+        arena->allocator.free = malloc_free;
+    }
+}
+
+// Empties the arena without touching its allocator
+static void arena_reset(arena_t* arena) {
+    allocator_t allocator = arena->allocator;
+    arena_init(arena, &allocator);
+}
+
+void* arena_alloc(arena_t* arena, size_t size) {
+    size_t rounded;
+    size_t class = arena_class(size, &rounded);
+
+    // Recycle a freed block of the same class if there is one
+    free_block_t* block = arena->free_lists[class];
+    if (block != NULL) {
+        arena->free_lists[class] = block->next;
+        return block;
+    }
+
+    if (rounded > ARENA_LARGE_BLOCK) {
+        arena_chunk_t* chunk = arena_new_chunk(arena, rounded);
+        return chunk == NULL ? NULL : (void*)(chunk + 1);
+    }
+
+    if (arena->cursor == NULL ||
+        (size_t)(arena->end - arena->cursor) < rounded) {
+        size_t size = arena->bytes;
+        if (size < ARENA_MIN_CHUNK_SIZE) {
+            size = ARENA_MIN_CHUNK_SIZE;
+        } else if (size > ARENA_CHUNK_SIZE) {
+            size = ARENA_CHUNK_SIZE;
+        }
+        while (size < rounded) {
+            size <<= 1;
+        }
+        arena_chunk_t* chunk = arena_new_chunk(arena, size);
+        if (chunk == NULL) {
+            return NULL;
+        }
+        arena->cursor = (char*)(chunk + 1);
+        arena->end = arena->cursor + size;
+    }
+
+    void* ptr = arena->cursor;
+    arena->cursor += rounded;
+    return ptr;
+}
+
+void arena_free(arena_t* arena, void* ptr, size_t size) {
+    if (ptr == NULL) {
+        return;
+    }
+    size_t rounded;
+    size_t class = arena_class(size, &rounded);
+    free_block_t* block = ptr;
+    block->next = arena->free_lists[class];
+    arena->free_lists[class] = block;
+}
+
+void arena_release(arena_t* arena) {
+    arena_chunk_t* chunk = arena->chunks;
+    while (chunk != NULL) {
+        arena_chunk_t* next = chunk->next;
+        allocator_free(&arena->allocator, chunk, sizeof(*chunk) + chunk->size);
+        chunk = next;
+    }
+    arena_reset(arena);
+}
+
+void arena_merge(arena_t* dst, arena_t* src) {
+    if (src->chunks == NULL) {
+        return;
+    }
+    arena_chunk_t* last = src->chunks;
+    while (last->next != NULL) {
+        last = last->next;
+    }
+    last->next = dst->chunks;
+    dst->chunks = src->chunks;
+    dst->bytes += src->bytes;
+    arena_reset(src);
+}
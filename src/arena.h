@@ -0,0 +1,59 @@
+/**
+ * @file arena.h
+ * @brief Private chunked arena allocator used by the containers.
+ *
+ * Memory is carved out of large chunks with a bump pointer. Freed blocks are
+ * kept on per-size-class free lists and recycled by later allocations of the
+ * same class; chunks are only returned to the system when the arena is
+ * released, which frees everything in O(chunks).
+ */
+
+#ifndef ARENA_H
+#define ARENA_H
+
+#include "allocator.h"
+#include <stdbool.h>
+#include <stddef.h>
+
+// Blocks up to ARENA_SMALL_MAX bytes are rounded to a multiple of
+// ARENA_ALIGN, larger ones to a power of two
+#define ARENA_ALIGN 16
+#define ARENA_SMALL_MAX 1024
+#define ARENA_NUM_CLASSES (ARENA_SMALL_MAX / ARENA_ALIGN + 64)
+
+typedef struct arena_chunk_t arena_chunk_t;
+
+typedef struct arena_t {
+    arena_chunk_t* chunks;
+    char* cursor;
+    char* end;
+    void* free_lists[ARENA_NUM_CLASSES];
+    size_t bytes;
+    // Source of the chunks, also used by the owning container for its other
+    // allocations
+    allocator_t allocator;
+} arena_t;
+
+// Initializes an empty arena drawing from `allocator`, or from malloc() and
+// free() if it is NULL
+void arena_init(arena_t* arena, const allocator_t* allocator);
+void* arena_alloc(arena_t* arena, size_t size);
+void arena_free(arena_t* arena, void* ptr, size_t size);
+void arena_release(arena_t* arena);
+
+// Moves all chunks of `src` into `dst`, so that blocks allocated from `src`
+// may be freed to `dst` and are released with it. `src` is left empty; its
+// free blocks and unused chunk tail are not reused until `dst` is released.
+// Both arenas must draw from the same allocator.
+void arena_merge(arena_t* dst, arena_t* src);
+
+// Whether two allocators are interchangeable
+bool allocator_equal(const allocator_t* a, const allocator_t* b);
+
+// Allocate and free directly through an allocator, bypassing the arena. Used
+// for container structures and arrays that are not worth recycling.
+void* allocator_alloc(const allocator_t* allocator, size_t size);
+void* allocator_calloc(const allocator_t* allocator, size_t n, size_t size);
+void allocator_free(const allocator_t* allocator, void* ptr, size_t size);
+
+#endif // ARENA_H
@@ -0,0 +1,407 @@
+#include "concurrenthashtable.h"
+#include "epoch.h"
+#include "hashtable_internal.h"
+#include <pthread.h>
+#include <stdatomic.h>
+
+// Number of locks guarding the buckets, must be a power of two
+#define CHT_NUM_STRIPES 64
+// Maximum average chain length before the table starts growing
+#define CHT_MAX_LOAD_FACTOR 1.0
+// Number of non-empty buckets migrated by each rehash step
+#define CHT_REHASH_STEP 1
+// Maximum number of empty buckets visited by each rehash step
+#define CHT_REHASH_EMPTY_VISITS 10
+#define CACHE_LINE_SIZE 64
+
+// Entries are immutable once published, except for their `next` pointer
+typedef struct centry_t {
+    epoch_node_t retire;
+    _Atomic(struct centry_t*) next;
+    uint64_t hash;
+    void* object;
+    size_t key_len;
+    char key[];
+} centry_t;
+
+typedef struct bucket_array_t {
+    epoch_node_t retire;
+    size_t size;
+    _Atomic(centry_t*) buckets[];
+} bucket_array_t;
+
+// Each lock sits on its own cache line to avoid false sharing
+typedef struct stripe_t {
+    _Alignas(CACHE_LINE_SIZE) pthread_mutex_t lock;
+    // Odd while a chain of the stripe is being moved to the new bucket array,
+    // so that readers can tell whether a miss raced with the relinking
+    _Atomic uint64_t seq;
+} stripe_t;
+
+typedef struct _concurrent_hash_table {
+    _Atomic(bucket_array_t*) table;
+    // Bucket array whose chains are still being moved into `table`, or NULL
+    _Atomic(bucket_array_t*) old;
+    // Next bucket of `old` to migrate, guarded by `rehash_lock`
+    size_t rehash_index;
+    pthread_mutex_t rehash_lock;
+    _Atomic size_t count;
+    hash_function* hash;
+    uint64_t seed;
+    epoch_domain_t* epoch;
+    stripe_t stripes[CHT_NUM_STRIPES];
+} concurrent_hash_table_t;
+
+static uint64_t cht_hash(concurrent_hash_table_t* ht, const char* key,
+                         size_t len) {
+    if (ht->hash != NULL) {
+        return hash_mix(ht->hash(key));
+    }
+    return hash_wyhash(key, len, ht->seed);
+}
+
+// Bucket `i` is guarded by stripe `i % CHT_NUM_STRIPES`. Since tables have at
+// least CHT_NUM_STRIPES buckets, the stripe of a key never changes on resize.
+static stripe_t* cht_stripe_for(concurrent_hash_table_t* ht, uint64_t hash) {
+    return &ht->stripes[hash & (CHT_NUM_STRIPES - 1)];
+}
+
+static bucket_array_t* bucket_array_create(size_t size) {
+    if (size >
+        (SIZE_MAX - sizeof(bucket_array_t)) / sizeof(_Atomic(centry_t*))) {
+        return NULL;
+    }
+    bucket_array_t* table =
+        calloc(1, sizeof(*table) + size * sizeof(_Atomic(centry_t*)));
+    if (table == NULL) {
+        return NULL;
+    }
+    table->size = size;
+    return table;
+}
+
+static centry_t* centry_create(const char* key, size_t len, uint64_t hash,
+                               void* obj) {
+    centry_t* e = malloc(sizeof(*e) + len + 1);
+    if (e == NULL) {
+        return NULL;
+    }
+    atomic_init(&e->next, NULL);
+    e->hash = hash;
+    e->object = obj;
+    e->key_len = len;
+    memcpy(e->key, key, len + 1);
+    return e;
+}
+
+static centry_t* cht_find(bucket_array_t* table, const char* key, size_t len,
+                          uint64_t hash) {
+    centry_t* e = atomic_load_explicit(
+        &table->buckets[hash & (table->size - 1)], memory_order_acquire);
+    while (e != NULL &&
+           !key_matches(e->hash, e->key_len, e->key, hash, len, key)) {
+        e = atomic_load_explicit(&e->next, memory_order_acquire);
+    }
+    return e;
+}
+
+// Unlinks the entry matching the key from its chain. Must be called with the
+// key's stripe held.
+static centry_t* cht_unlink(bucket_array_t* table, const char* key,
+                            size_t len, uint64_t hash) {
+    _Atomic(centry_t*)* link = &table->buckets[hash & (table->size - 1)];
+    centry_t* e = atomic_load_explicit(link, memory_order_relaxed);
+    while (e != NULL &&
+           !key_matches(e->hash, e->key_len, e->key, hash, len, key)) {
+        link = &e->next;
+        e = atomic_load_explicit(link, memory_order_relaxed);
+    }
+    if (e != NULL) {
+        // Readers already on `e` can still follow its `next` pointer
+        atomic_store_explicit(
+            link, atomic_load_explicit(&e->next, memory_order_relaxed),
+            memory_order_release);
+    }
+    return e;
+}
+
+// Moves a few chains of the old bucket array into the new one. Entries are
+// relinked in place, so a reader on a moving chain may be led into another
+// one; readers detect this through the stripe's sequence number and retry.
+static void cht_rehash_step(concurrent_hash_table_t* ht,
+                            epoch_record_t* record) {
+    if (atomic_load(&ht->old) == NULL) {
+        return;
+    }
+    pthread_mutex_lock(&ht->rehash_lock);
+    bucket_array_t* old = atomic_load(&ht->old);
+    if (old == NULL) {
+        pthread_mutex_unlock(&ht->rehash_lock);
+        return;
+    }
+    bucket_array_t* table = atomic_load(&ht->table);
+
+    size_t moved = 0;
+    size_t empty_visits = 0;
+    while (moved < CHT_REHASH_STEP && ht->rehash_index < old->size) {
+        size_t i = ht->rehash_index++;
+        stripe_t* stripe = &ht->stripes[i & (CHT_NUM_STRIPES - 1)];
+        pthread_mutex_lock(&stripe->lock);
+        centry_t* e = atomic_load_explicit(&old->buckets[i],
+                                           memory_order_relaxed);
+        if (e == NULL) {
+            pthread_mutex_unlock(&stripe->lock);
+            if (++empty_visits >= CHT_REHASH_EMPTY_VISITS) {
+                break;
+            }
+            continue;
+        }
+
+        atomic_fetch_add(&stripe->seq, 1);
+        while (e != NULL) {
+            centry_t* next = atomic_load_explicit(&e->next,
+                                                  memory_order_relaxed);
+            _Atomic(centry_t*)* bucket =
+                &table->buckets[e->hash & (table->size - 1)];
+            atomic_store_explicit(
+                &e->next, atomic_load_explicit(bucket, memory_order_relaxed),
+                memory_order_release);
+            atomic_store_explicit(bucket, e, memory_order_release);
+            e = next;
+        }
+        atomic_store_explicit(&old->buckets[i], NULL, memory_order_release);
+        atomic_fetch_add(&stripe->seq, 1);
+        pthread_mutex_unlock(&stripe->lock);
+        moved += 1;
+    }
+
+    // All buckets migrated, retire the old array
+    if (ht->rehash_index >= old->size) {
+        atomic_store(&ht->old, NULL);
+        epoch_retire(record, &old->retire);
+    }
+    pthread_mutex_unlock(&ht->rehash_lock);
+}
+
+// Starts moving the entries into a bucket array twice as large. Writers load
+// `table` before `old` under their stripe, so storing `old` first guarantees
+// that they always see every array that may hold their key.
+static void cht_grow(concurrent_hash_table_t* ht) {
+    if (atomic_load(&ht->old) != NULL) {
+        return;
+    }
+    pthread_mutex_lock(&ht->rehash_lock);
+    bucket_array_t* table = atomic_load(&ht->table);
+    if (atomic_load(&ht->old) != NULL ||
+        atomic_load(&ht->count) <= table->size * CHT_MAX_LOAD_FACTOR) {
+        // Another writer already grew the table
+        pthread_mutex_unlock(&ht->rehash_lock);
+        return;
+    }
+
+    // If the new array cannot be allocated, keep working with the current one
+    bucket_array_t* grown = bucket_array_create(table->size * 2);
+    if (grown != NULL) {
+        ht->rehash_index = 0;
+        atomic_store(&ht->old, table);
+        atomic_store(&ht->table, grown);
+    }
+    pthread_mutex_unlock(&ht->rehash_lock);
+}
+
+concurrent_hash_table_t* concurrent_hash_table_create(size_t size,
+                                                      hash_function* hf) {
+    concurrent_hash_table_t* ht = aligned_alloc(
+        CACHE_LINE_SIZE, (sizeof(*ht) + CACHE_LINE_SIZE - 1) &
+                             ~(size_t)(CACHE_LINE_SIZE - 1));
+    if (ht == NULL) {
+        return NULL;
+    }
+    size = next_power_of_two(size);
+    if (size == 0) {
+        free(ht);
+        return NULL;
+    }
+    if (size < CHT_NUM_STRIPES) {
+        size = CHT_NUM_STRIPES;
+    }
+    bucket_array_t* table = bucket_array_create(size);
+    ht->epoch = epoch_domain_create(free);
+    if (table == NULL || ht->epoch == NULL) {
+        free(table);
+        if (ht->epoch != NULL) {
+            epoch_domain_destroy(ht->epoch);
+        }
+        free(ht);
+        return NULL;
+    }
+    atomic_init(&ht->table, table);
+    atomic_init(&ht->old, NULL);
+    ht->rehash_index = 0;
+    pthread_mutex_init(&ht->rehash_lock, NULL);
+    atomic_init(&ht->count, 0);
+    ht->hash = hf;
+    ht->seed = hf == NULL ? hash_random_seed() : 0;
+    for (size_t i = 0; i < CHT_NUM_STRIPES; i++) {
+        pthread_mutex_init(&ht->stripes[i].lock, NULL);
+        atomic_init(&ht->stripes[i].seq, 0);
+    }
+    return ht;
+}
+
+static void bucket_array_destroy(bucket_array_t* table) {
+    for (size_t i = 0; i < table->size; i++) {
+        centry_t* e = atomic_load(&table->buckets[i]);
+        while (e != NULL) {
+            centry_t* next = atomic_load(&e->next);
+            free(e);
+            e = next;
+        }
+    }
+    free(table);
+}
+
+void concurrent_hash_table_destroy(concurrent_hash_table_t* ht) {
+    bucket_array_destroy(atomic_load(&ht->table));
+    // Buckets of the old array that are not migrated yet hold entries too
+    if (atomic_load(&ht->old) != NULL) {
+        bucket_array_destroy(atomic_load(&ht->old));
+    }
+    epoch_domain_destroy(ht->epoch);
+    pthread_mutex_destroy(&ht->rehash_lock);
+    for (size_t i = 0; i < CHT_NUM_STRIPES; i++) {
+        pthread_mutex_destroy(&ht->stripes[i].lock);
+    }
+    free(ht);
+}
+
+size_t concurrent_hash_table_size(concurrent_hash_table_t* ht) {
+    if (ht == NULL) {
+        return 0;
+    }
+    return atomic_load_explicit(&ht->count, memory_order_relaxed);
+}
+
+bool concurrent_hash_table_insert(concurrent_hash_table_t* ht, const char* key,
+                                  void* obj) {
+    if (ht == NULL || key == NULL || obj == NULL) {
+        return false;
+    }
+
+    size_t len = strlen(key);
+    uint64_t hash = cht_hash(ht, key, len);
+    pthread_mutex_t* lock = &cht_stripe_for(ht, hash)->lock;
+    epoch_record_t* record = epoch_enter(ht->epoch);
+    if (record == NULL) {
+        return false;
+    }
+    pthread_mutex_lock(lock);
+
+    // The key's chains cannot be migrated while its stripe is held
+    bucket_array_t* table = atomic_load(&ht->table);
+    bucket_array_t* old = atomic_load(&ht->old);
+
+    // If the key already exists, do not overwrite
+    if (cht_find(table, key, len, hash) != NULL ||
+        (old != NULL && cht_find(old, key, len, hash) != NULL)) {
+        pthread_mutex_unlock(lock);
+        epoch_exit(record);
+        return false;
+    }
+
+    centry_t* e = centry_create(key, len, hash, obj);
+    if (e == NULL) {
+        pthread_mutex_unlock(lock);
+        epoch_exit(record);
+        return false;
+    }
+
+    // Publish the fully initialized entry at the head of the chain
+    _Atomic(centry_t*)* bucket = &table->buckets[hash & (table->size - 1)];
+    atomic_init(&e->next, atomic_load_explicit(bucket, memory_order_relaxed));
+    atomic_store_explicit(bucket, e, memory_order_release);
+    size_t count = atomic_fetch_add(&ht->count, 1) + 1;
+    pthread_mutex_unlock(lock);
+
+    if (count > table->size * CHT_MAX_LOAD_FACTOR) {
+        cht_grow(ht);
+    }
+    cht_rehash_step(ht, record);
+    epoch_exit(record);
+    return true;
+}
+
+void* concurrent_hash_table_lookup(concurrent_hash_table_t* ht,
+                                   const char* key) {
+    if (ht == NULL || key == NULL) {
+        return NULL;
+    }
+
+    size_t len = strlen(key);
+    uint64_t hash = cht_hash(ht, key, len);
+    epoch_record_t* record = epoch_enter(ht->epoch);
+    if (record == NULL) {
+        return NULL;
+    }
+    _Atomic uint64_t* seq = &cht_stripe_for(ht, hash)->seq;
+    centry_t* e;
+    while (true) {
+        uint64_t before = atomic_load(seq);
+        bucket_array_t* table = atomic_load(&ht->table);
+        e = cht_find(table, key, len, hash);
+        if (e == NULL) {
+            bucket_array_t* old = atomic_load(&ht->old);
+            if (old != NULL) {
+                e = cht_find(old, key, len, hash);
+            }
+        }
+        // A miss only counts if no chain of the stripe moved meanwhile
+        atomic_thread_fence(memory_order_acquire);
+        if (e != NULL || ((before & 1) == 0 &&
+                          atomic_load_explicit(seq, memory_order_relaxed) ==
+                              before)) {
+            break;
+        }
+    }
+    void* obj = e == NULL ? NULL : e->object;
+    epoch_exit(record);
+    return obj;
+}
+
+void* concurrent_hash_table_delete(concurrent_hash_table_t* ht,
+                                   const char* key) {
+    if (ht == NULL || key == NULL) {
+        return NULL;
+    }
+
+    size_t len = strlen(key);
+    uint64_t hash = cht_hash(ht, key, len);
+    pthread_mutex_t* lock = &cht_stripe_for(ht, hash)->lock;
+    epoch_record_t* record = epoch_enter(ht->epoch);
+    if (record == NULL) {
+        return NULL;
+    }
+    pthread_mutex_lock(lock);
+
+    // Search the entry to be deleted
+    bucket_array_t* table = atomic_load(&ht->table);
+    bucket_array_t* old = atomic_load(&ht->old);
+    centry_t* e = cht_unlink(table, key, len, hash);
+    if (e == NULL && old != NULL) {
+        e = cht_unlink(old, key, len, hash);
+    }
+
+    void* obj = NULL;
+    if (e != NULL) {
+        atomic_fetch_sub(&ht->count, 1);
+        obj = e->object;
+    }
+    pthread_mutex_unlock(lock);
+
+    if (e != NULL) {
+        epoch_retire(record, &e->retire);
+    }
+    cht_rehash_step(ht, record);
+    epoch_exit(record);
+    return obj;
+}
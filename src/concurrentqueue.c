@@ -0,0 +1,157 @@
+#include "concurrentqueue.h"
+#include "epoch.h"
+#include <stdatomic.h>
+
+#define CACHE_LINE_SIZE 64
+
+// The queue always holds a dummy node at its head; the object of a node is
+// owned by the queue from the moment its predecessor becomes the dummy
+typedef struct qnode_t {
+    epoch_node_t retire;
+    _Atomic(struct qnode_t*) next;
+    void* object;
+} qnode_t;
+
+// Head and tail sit on separate cache lines, so producers and consumers do
+// not invalidate each other's line on every operation
+typedef struct _concurrent_queue {
+    _Alignas(CACHE_LINE_SIZE) _Atomic(qnode_t*) head;
+    _Alignas(CACHE_LINE_SIZE) _Atomic(qnode_t*) tail;
+    _Alignas(CACHE_LINE_SIZE) epoch_domain_t* epoch;
+} concurrent_queue_t;
+
+static qnode_t* qnode_create(void* obj) {
+    qnode_t* node = malloc(sizeof(*node));
+    if (node == NULL) {
+        return NULL;
+    }
+    atomic_init(&node->next, NULL);
+    node->object = obj;
+    return node;
+}
+
+concurrent_queue_t* concurrent_queue_create() {
+    concurrent_queue_t* q = aligned_alloc(CACHE_LINE_SIZE, sizeof(*q));
+    if (q == NULL) {
+        return NULL;
+    }
+    qnode_t* dummy = qnode_create(NULL);
+    q->epoch = epoch_domain_create(free);
+    if (dummy == NULL || q->epoch == NULL) {
+        free(dummy);
+        if (q->epoch != NULL) {
+            epoch_domain_destroy(q->epoch);
+        }
+        free(q);
+        return NULL;
+    }
+    atomic_init(&q->head, dummy);
+    atomic_init(&q->tail, dummy);
+    return q;
+}
+
+void concurrent_queue_destroy(concurrent_queue_t* q, void (*free_func)(void*)) {
+    if (q == NULL) {
+        return;
+    }
+    // The dummy's object has already been dequeued
+    qnode_t* node = atomic_load(&q->head);
+    bool dummy = true;
+    while (node != NULL) {
+        qnode_t* next = atomic_load(&node->next);
+        if (!dummy && free_func != NULL) {
+            free_func(node->object);
+        }
+        free(node);
+        node = next;
+        dummy = false;
+    }
+    epoch_domain_destroy(q->epoch);
+    free(q);
+}
+
+bool concurrent_queue_push_back(concurrent_queue_t* q, void* obj) {
+    if (q == NULL || obj == NULL) {
+        return false;
+    }
+    qnode_t* node = qnode_create(obj);
+    if (node == NULL) {
+        return false;
+    }
+
+    epoch_record_t* record = epoch_enter(q->epoch);
+    if (record == NULL) {
+        free(node);
+        return false;
+    }
+    qnode_t* tail;
+    while (true) {
+        tail = atomic_load_explicit(&q->tail, memory_order_acquire);
+        qnode_t* next = atomic_load_explicit(&tail->next, memory_order_acquire);
+        if (tail != atomic_load_explicit(&q->tail, memory_order_acquire)) {
+            continue;
+        }
+        if (next != NULL) {
+            // The tail is lagging behind, help the other producer finish
+            atomic_compare_exchange_weak_explicit(&q->tail, &tail, next,
+                                                  memory_order_release,
+                                                  memory_order_relaxed);
+            continue;
+        }
+        if (atomic_compare_exchange_weak_explicit(&tail->next, &next, node,
+                                                  memory_order_release,
+                                                  memory_order_relaxed)) {
+            break;
+        }
+    }
+    // Swing the tail to the new node; failing means someone already helped
+    atomic_compare_exchange_strong_explicit(&q->tail, &tail, node,
+                                            memory_order_release,
+                                            memory_order_relaxed);
+    epoch_exit(record);
+    return true;
+}
+
+void* concurrent_queue_pop_front(concurrent_queue_t* q) {
+    if (q == NULL) {
+        return NULL;
+    }
+
+    epoch_record_t* record = epoch_enter(q->epoch);
+    if (record == NULL) {
+        return NULL;
+    }
+    qnode_t* head;
+    void* obj;
+    while (true) {
+        head = atomic_load_explicit(&q->head, memory_order_acquire);
+        qnode_t* tail = atomic_load_explicit(&q->tail, memory_order_acquire);
+        qnode_t* next = atomic_load_explicit(&head->next, memory_order_acquire);
+        if (head != atomic_load_explicit(&q->head, memory_order_acquire)) {
+            continue;
+        }
+        if (next == NULL) {
+            // Only the dummy is left
+            epoch_exit(record);
+            return NULL;
+        }
+        if (head == tail) {
+            // The tail is lagging behind, help the producer finish
+            atomic_compare_exchange_weak_explicit(&q->tail, &tail, next,
+                                                  memory_order_release,
+                                                  memory_order_relaxed);
+            continue;
+        }
+        // Read the object before another consumer can dequeue `next` too
+        obj = next->object;
+        if (atomic_compare_exchange_weak_explicit(&q->head, &head, next,
+                                                  memory_order_acq_rel,
+                                                  memory_order_relaxed)) {
+            break;
+        }
+    }
+    // `next` is the new dummy; the old one may still be read by other threads
+    epoch_retire(record, &head->retire);
+    epoch_exit(record);
+    return obj;
+}
@@ -0,0 +1,271 @@
+#include "epoch.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+// Number of nodes a thread retires before trying to advance the epoch
+#define EPOCH_RETIRE_THRESHOLD 64
+// Retired nodes are kept in one limbo list per epoch modulo this value
+#define EPOCH_NUM_LIMBO 3
+
+typedef struct limbo_t {
+    uint64_t epoch;
+    epoch_node_t* head;
+} limbo_t;
+
+struct epoch_record_t {
+    // Epoch observed when entering, shifted left by one, with the low bit set
+    // while the thread is inside a critical section
+    _Atomic uint64_t state;
+    // Whether a live thread currently owns this record
+    atomic_bool owned;
+    // The owner's link to this record, guarded by epoch_entries_lock
+    struct epoch_entry_t* entry;
+    struct epoch_record_t* next;
+    epoch_domain_t* domain;
+    size_t nesting;
+    size_t retired_count;
+    limbo_t limbo[EPOCH_NUM_LIMBO];
+};
+
+struct epoch_domain_t {
+    _Atomic uint64_t epoch;
+    _Atomic(epoch_record_t*) records;
+    epoch_free_function* free_func;
+};
+
+// A thread's link to its record in one domain. Every thread keeps a list of
+// them under a single process-wide key, so the number of domains is not
+// bounded by PTHREAD_KEYS_MAX. The list is only changed by its thread.
+typedef struct epoch_entry_t {
+    struct epoch_entry_t* next;
+    epoch_domain_t* domain;
+    // Cleared when the domain is destroyed before the thread exits
+    _Atomic(epoch_record_t*) record;
+} epoch_entry_t;
+
+static pthread_key_t epoch_key;
+static pthread_once_t epoch_key_once = PTHREAD_ONCE_INIT;
+static bool epoch_key_created;
+// Pairs records with entries across thread exits and domain destruction
+static pthread_mutex_t epoch_entries_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static void epoch_free_list(epoch_domain_t* domain, epoch_node_t* node) {
+    while (node != NULL) {
+        epoch_node_t* next = node->next;
+        domain->free_func(node);
+        node = next;
+    }
+}
+
+// Frees the limbo lists that no reader can reach anymore
+static void epoch_collect(epoch_record_t* record, uint64_t epoch) {
+    for (size_t i = 0; i < EPOCH_NUM_LIMBO; i++) {
+        limbo_t* limbo = &record->limbo[i];
+        if (limbo->head != NULL && limbo->epoch + 2 <= epoch) {
+            epoch_free_list(record->domain, limbo->head);
+            limbo->head = NULL;
+        }
+    }
+}
+
+// Advances the global epoch if every active thread has observed it
+static uint64_t epoch_try_advance(epoch_domain_t* domain) {
+    uint64_t epoch = atomic_load(&domain->epoch);
+    epoch_record_t* r = atomic_load(&domain->records);
+    while (r != NULL) {
+        uint64_t state = atomic_load(&r->state);
+        if ((state & 1) && (state >> 1) != epoch) {
+            return epoch;
+        }
+        r = r->next;
+    }
+    if (atomic_compare_exchange_strong(&domain->epoch, &epoch, epoch + 1)) {
+        return epoch + 1;
+    }
+    return epoch;
+}
+
+// Releases a thread's records when the thread exits, so that other threads
+// can adopt them together with their pending limbo lists
+static void epoch_thread_exit(void* ptr) {
+    epoch_entry_t* entry = ptr;
+    pthread_mutex_lock(&epoch_entries_lock);
+    while (entry != NULL) {
+        epoch_entry_t* next = entry->next;
+        epoch_record_t* record = atomic_load(&entry->record);
+        if (record != NULL) {
+            record->entry = NULL;
+            atomic_store(&record->owned, false);
+        }
+        free(entry);
+        entry = next;
+    }
+    pthread_mutex_unlock(&epoch_entries_lock);
+}
+
+static void epoch_create_key() {
+    epoch_key_created = pthread_key_create(&epoch_key, epoch_thread_exit) == 0;
+}
+
+static epoch_record_t* epoch_find_record(epoch_domain_t* domain) {
+    epoch_entry_t* entry = pthread_getspecific(epoch_key);
+    while (entry != NULL) {
+        if (entry->domain == domain) {
+            // A cleared entry belongs to a destroyed domain at the same address
+            epoch_record_t* record = atomic_load(&entry->record);
+            if (record != NULL) {
+                return record;
+            }
+        }
+        entry = entry->next;
+    }
+    return NULL;
+}
+
+static epoch_record_t* epoch_acquire_record(epoch_domain_t* domain) {
+    epoch_entry_t* entry = malloc(sizeof(*entry));
+    if (entry == NULL) {
+        return NULL;
+    }
+
+    // Adopt a record left behind by an exited thread if there is one
+    epoch_record_t* r = atomic_load(&domain->records);
+    while (r != NULL) {
+        bool expected = false;
+        if (!atomic_load(&r->owned) &&
+            atomic_compare_exchange_strong(&r->owned, &expected, true)) {
+            break;
+        }
+        r = r->next;
+    }
+
+    if (r == NULL) {
+        r = calloc(1, sizeof(*r));
+        if (r == NULL) {
+            free(entry);
+            return NULL;
+        }
+        atomic_init(&r->state, 0);
+        atomic_init(&r->owned, true);
+        r->domain = domain;
+        epoch_record_t* head = atomic_load(&domain->records);
+        do {
+            r->next = head;
+        } while (!atomic_compare_exchange_weak(&domain->records, &head, r));
+    }
+
+    entry->next = pthread_getspecific(epoch_key);
+    entry->domain = domain;
+    atomic_init(&entry->record, r);
+    pthread_mutex_lock(&epoch_entries_lock);
+    if (pthread_setspecific(epoch_key, entry) != 0) {
+        // Leave the record for another thread to adopt
+        atomic_store(&r->owned, false);
+        pthread_mutex_unlock(&epoch_entries_lock);
+        free(entry);
+        return NULL;
+    }
+    r->entry = entry;
+    pthread_mutex_unlock(&epoch_entries_lock);
+
+    // Drop the entries of destroyed domains
+    epoch_entry_t** link = &entry->next;
+    while (*link != NULL) {
+        epoch_entry_t* e = *link;
+        if (atomic_load(&e->record) == NULL) {
+            *link = e->next;
+            free(e);
+        } else {
+            link = &e->next;
+        }
+    }
+    return r;
+}
+
+epoch_domain_t* epoch_domain_create(epoch_free_function* free_func) {
+    epoch_domain_t* domain = malloc(sizeof(*domain));
+    if (domain == NULL) {
+        return NULL;
+    }
+    pthread_once(&epoch_key_once, epoch_create_key);
+    if (!epoch_key_created) {
+        free(domain);
+        return NULL;
+    }
+    atomic_init(&domain->epoch, 0);
+    atomic_init(&domain->records, NULL);
+    domain->free_func = free_func;
+    return domain;
+}
+
+void epoch_domain_destroy(epoch_domain_t* domain) {
+    // Threads that are still alive drop their entries lazily
+    pthread_mutex_lock(&epoch_entries_lock);
+    epoch_record_t* r = atomic_load(&domain->records);
+    while (r != NULL) {
+        if (r->entry != NULL) {
+            atomic_store(&r->entry->record, NULL);
+        }
+        r = r->next;
+    }
+    pthread_mutex_unlock(&epoch_entries_lock);
+
+    r = atomic_load(&domain->records);
+    while (r != NULL) {
+        epoch_record_t* next = r->next;
+        for (size_t i = 0; i < EPOCH_NUM_LIMBO; i++) {
+            epoch_free_list(domain, r->limbo[i].head);
+        }
+        free(r);
+        r = next;
+    }
+    free(domain);
+}
+
+epoch_record_t* epoch_enter(epoch_domain_t* domain) {
+    epoch_record_t* record = epoch_find_record(domain);
+    if (record == NULL) {
+        record = epoch_acquire_record(domain);
+        if (record == NULL) {
+            return NULL;
+        }
+    }
+    if (record->nesting++ == 0) {
+        uint64_t epoch = atomic_load(&domain->epoch);
+        atomic_store(&record->state, (epoch << 1) | 1);
+        // The record must be visibly active before any shared pointer is read
+        atomic_thread_fence(memory_order_seq_cst);
+    }
+    return record;
+}
+
+void epoch_exit(epoch_record_t* record) {
+    if (--record->nesting == 0) {
+        uint64_t state = atomic_load_explicit(&record->state,
+                                              memory_order_relaxed);
+        atomic_store_explicit(&record->state, state & ~(uint64_t)1,
+                              memory_order_release);
+    }
+}
+
+void epoch_retire(epoch_record_t* record, epoch_node_t* node) {
+    // The node must be unlinked before the retirement epoch is read
+    atomic_thread_fence(memory_order_seq_cst);
+    uint64_t epoch = atomic_load(&record->domain->epoch);
+    limbo_t* limbo = &record->limbo[epoch % EPOCH_NUM_LIMBO];
+    if (limbo->epoch != epoch) {
+        // The list holds nodes retired at least three epochs ago
+        epoch_free_list(record->domain, limbo->head);
+        limbo->head = NULL;
+        limbo->epoch = epoch;
+    }
+    node->next = limbo->head;
+    limbo->head = node;
+
+    if (++record->retired_count >= EPOCH_RETIRE_THRESHOLD) {
+        record->retired_count = 0;
+        epoch_collect(record, epoch_try_advance(record->domain));
+    }
+}
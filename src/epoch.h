@@ -0,0 +1,48 @@
+/**
+ * @file epoch.h
+ * @brief Private epoch-based memory reclamation for lock-free readers.
+ *
+ * Readers bracket every access to shared nodes with epoch_enter() and
+ * epoch_exit(). Writers unlink nodes and hand them to epoch_retire(); a
+ * retired node is only freed once every thread that could still hold a
+ * pointer to it has left its critical section, which is detected when the
+ * global epoch has advanced twice since the node was retired.
+ */
+
+#ifndef EPOCH_H
+#define EPOCH_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+typedef struct epoch_domain_t epoch_domain_t;
+typedef struct epoch_record_t epoch_record_t;
+
+/** Function called to free a retired node. */
+typedef void epoch_free_function(void* ptr);
+
+// Link through which a retired node waits for reclamation. It must be the
+// first member of every node retired to a domain, so that the domain's free
+// function receives the start of the allocation. Retiring never allocates.
+typedef struct epoch_node_t {
+    struct epoch_node_t* next;
+} epoch_node_t;
+
+// Creates a domain whose retired nodes are all freed with `free_func`
+epoch_domain_t* epoch_domain_create(epoch_free_function* free_func);
+
+// Frees every node still waiting for reclamation. No thread may be inside a
+// critical section of the domain.
+void epoch_domain_destroy(epoch_domain_t* domain);
+
+// Enters a critical section and returns the calling thread's record, which
+// must be passed to epoch_exit() and epoch_retire(). Critical sections nest.
+// Returns NULL, without entering, if the record cannot be allocated.
+epoch_record_t* epoch_enter(epoch_domain_t* domain);
+void epoch_exit(epoch_record_t* record);
+
+// Schedules `node` to be freed once no reader can reach it. Must be called
+// inside a critical section, after the node has been unlinked.
+void epoch_retire(epoch_record_t* record, epoch_node_t* node);
+
+#endif // EPOCH_H
@@ -0,0 +1,111 @@
+#include "hashfunctions.h"
+#include <string.h>
+#include <time.h>
+
+#ifdef __linux__
+#include <sys/random.h>
+#endif
+
+// Default secret of wyhash
+static const uint64_t wyhash_secret[4] = {
+    0x2d358dccaa6c78a5ULL, 0x8bb84b93962eacc9ULL, 0x4b33a62ed433d4a3ULL,
+    0x4d5a2da51de1aa47ULL};
+
+// Multiplies two 64-bit values, returning the low and high halves in place
+static inline void wyhash_mum(uint64_t* a, uint64_t* b) {
+    __uint128_t r = (__uint128_t)*a * *b;
+    *a = (uint64_t)r;
+    *b = (uint64_t)(r >> 64);
+}
+
+static inline uint64_t wyhash_mix(uint64_t a, uint64_t b) {
+    wyhash_mum(&a, &b);
+    return a ^ b;
+}
+
+static inline uint64_t wyhash_read8(const uint8_t* p) {
+    uint64_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline uint64_t wyhash_read4(const uint8_t* p) {
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+// Reads 1 to 3 bytes
+static inline uint64_t wyhash_read3(const uint8_t* p, size_t k) {
+    return ((uint64_t)p[0] << 16) | ((uint64_t)p[k >> 1] << 8) | p[k - 1];
+}
+
+uint64_t hash_wyhash(const void* key, size_t len, uint64_t seed) {
+    const uint64_t* s = wyhash_secret;
+    const uint8_t* p = key;
+    uint64_t a;
+    uint64_t b;
+    seed ^= wyhash_mix(seed ^ s[0], s[1]);
+
+    if (len <= 16) {
+        if (len >= 4) {
+            size_t offset = (len >> 3) << 2;
+            a = (wyhash_read4(p) << 32) | wyhash_read4(p + offset);
+            b = (wyhash_read4(p + len - 4) << 32) |
+                wyhash_read4(p + len - 4 - offset);
+        } else if (len > 0) {
+            a = wyhash_read3(p, len);
+            b = 0;
+        } else {
+            a = 0;
+            b = 0;
+        }
+    } else {
+        size_t i = len;
+        // Three independent lanes keep the multipliers busy on long keys
+        if (i >= 48) {
+            uint64_t see1 = seed;
+            uint64_t see2 = seed;
+            do {
+                seed = wyhash_mix(wyhash_read8(p) ^ s[1],
+                                  wyhash_read8(p + 8) ^ seed);
+                see1 = wyhash_mix(wyhash_read8(p + 16) ^ s[2],
+                                  wyhash_read8(p + 24) ^ see1);
+                see2 = wyhash_mix(wyhash_read8(p + 32) ^ s[3],
+                                  wyhash_read8(p + 40) ^ see2);
+                p += 48;
+                i -= 48;
+            } while (i >= 48);
+            seed ^= see1 ^ see2;
+        }
+        while (i > 16) {
+            seed =
+                wyhash_mix(wyhash_read8(p) ^ s[1], wyhash_read8(p + 8) ^ seed);
+            i -= 16;
+            p += 16;
+        }
+        a = wyhash_read8(p + i - 16);
+        b = wyhash_read8(p + i - 8);
+    }
+
+    a ^= s[1];
+    b ^= seed;
+    wyhash_mum(&a, &b);
+    return wyhash_mix(a ^ s[0] ^ len, b ^ s[1]);
+}
+
+uint64_t hash_random_seed(void) {
+    uint64_t seed = 0;
+#ifdef __linux__
+    if (getrandom(&seed, sizeof(seed), GRND_NONBLOCK) == sizeof(seed)) {
+        return seed;
+    }
+#endif
+    // Fall back to mixing the clock with stack and code addresses
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    seed = (uint64_t)ts.tv_nsec ^ ((uint64_t)ts.tv_sec << 32);
+    seed ^= (uint64_t)(uintptr_t)&seed;
+    seed ^= (uint64_t)(uintptr_t)&hash_random_seed << 17;
+    return hash_wyhash(&seed, sizeof(seed), seed);
+}
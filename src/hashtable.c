@@ -1,93 +1,339 @@
-#include "hashtable.h"
+#include "hashtable_internal.h"
 
-typedef struct entry_t {
-    char* key;
-    void* object;
-    struct entry_t* next;
-} entry_t;
+// Maximum average chain length before the table starts growing
+#define HT_MAX_LOAD_FACTOR 1.0
+// Minimum average chain length before the table starts shrinking
+#define HT_MIN_LOAD_FACTOR 0.125
+// Number of keys hashed and prefetched together by batched lookups
+#define HT_BATCH_SIZE 16
+// Number of non-empty buckets migrated by each rehash step
+#define HT_REHASH_STEP 1
+// Maximum number of empty buckets visited by each rehash step
+#define HT_REHASH_EMPTY_VISITS 10
 
-typedef struct _hash_table {
-    size_t size;
-    hash_function* hash;
-    entry_t** elements;
-} hash_table_t;
+static bool hash_table_is_rehashing(hash_table_t* ht) {
+    return ht->old_elements != NULL;
+}
+
+static void hash_table_rehash_step(hash_table_t* ht) {
+    if (!hash_table_is_rehashing(ht)) {
+        return;
+    }
+
+    size_t moved = 0;
+    size_t empty_visits = 0;
+    while (moved < HT_REHASH_STEP && ht->rehash_index < ht->old_size) {
+        entry_t* e = ht->old_elements[ht->rehash_index];
+        if (e == NULL) {
+            ht->rehash_index += 1;
+            if (++empty_visits >= HT_REHASH_EMPTY_VISITS) {
+                break;
+            }
+            continue;
+        }
 
-static size_t hash_table_index(hash_table_t* ht, const char* key) {
-    size_t index = ht->hash(key) % ht->size;
-    return index;
+        // Move the whole chain into the new bucket array
+        while (e != NULL) {
+            entry_t* next = e->next;
+            size_t index = e->hash & (ht->size - 1);
+            e->next = ht->elements[index];
+            ht->elements[index] = e;
+            e = next;
+        }
+        ht->old_elements[ht->rehash_index] = NULL;
+        ht->rehash_index += 1;
+        moved += 1;
+    }
+
+    // All buckets migrated, release the old array
+    if (ht->rehash_index >= ht->old_size) {
+        allocator_free(&ht->arena.allocator, ht->old_elements,
+                       ht->old_size * sizeof(entry_t*));
+        ht->old_elements = NULL;
+        ht->old_size = 0;
+        ht->rehash_index = 0;
+    }
 }
 
-hash_table_t* hash_table_create(size_t size, hash_function* hf) {
-    hash_table_t* ht = malloc(sizeof(*ht));
-    ht->size = size;
-    ht->hash = hf;
-    ht->elements = calloc(sizeof(entry_t*), size);
-    return ht;
+static void hash_table_resize(hash_table_t* ht, size_t new_size) {
+    if (hash_table_is_rehashing(ht) || new_size == ht->size) {
+        return;
+    }
+
+    // If the new array cannot be allocated, keep working with the current one
+    entry_t** elements =
+        allocator_calloc(&ht->arena.allocator, new_size, sizeof(entry_t*));
+    if (elements == NULL) {
+        return;
+    }
+
+    ht->old_elements = ht->elements;
+    ht->old_size = ht->size;
+    ht->rehash_index = 0;
+    ht->elements = elements;
+    ht->size = new_size;
 }
 
-void hash_table_destroy(hash_table_t* ht) {
-    free(ht->elements);
-    free(ht);
+static void hash_table_grow_if_needed(hash_table_t* ht) {
+    if (ht->count > ht->size * HT_MAX_LOAD_FACTOR) {
+        hash_table_resize(ht, ht->size * 2);
+    }
 }
 
-bool hash_table_insert(hash_table_t* ht, const char* key, void* obj) {
-    if (key == NULL || obj == NULL) {
-        return false;
+static void hash_table_shrink_if_needed(hash_table_t* ht) {
+    if (ht->size > ht->min_size &&
+        ht->count < ht->size * HT_MIN_LOAD_FACTOR) {
+        size_t new_size = next_power_of_two(ht->count * 2);
+        if (new_size < ht->min_size) {
+            new_size = ht->min_size;
+        }
+        hash_table_resize(ht, new_size);
     }
+}
 
-    // If the key already exists, do not overwrite
-    if (hash_table_lookup(ht, key) != NULL) {
+// Finds the entry for `key`, looking in the old bucket array too while a
+// rehash is in progress. If `prev_out` and `bucket_out` are given, they
+// receive the preceding entry in the chain and the bucket holding it.
+static entry_t* hash_table_find(hash_table_t* ht, const char* key, size_t len,
+                                uint64_t hash, entry_t** prev_out,
+                                entry_t*** bucket_out) {
+    entry_t** bucket = &ht->elements[hash & (ht->size - 1)];
+    entry_t* prev = NULL;
+    entry_t* e = *bucket;
+    HT_STAT_ADD(ht, searches, 1);
+    while (e != NULL &&
+           !key_matches(e->hash, e->key_len, e->key, hash, len, key)) {
+        HT_STAT_ADD(ht, probes, 1);
+        prev = e;
+        e = e->next;
+    }
+
+    if (e == NULL && hash_table_is_rehashing(ht)) {
+        size_t index = hash & (ht->old_size - 1);
+        if (index >= ht->rehash_index) {
+            bucket = &ht->old_elements[index];
+            prev = NULL;
+            e = *bucket;
+            while (e != NULL && !key_matches(e->hash, e->key_len, e->key,
+                                             hash, len, key)) {
+                HT_STAT_ADD(ht, probes, 1);
+                prev = e;
+                e = e->next;
+            }
+        }
+    }
+
+    if (e != NULL) {
+        HT_STAT_ADD(ht, probes, 1);
+    }
+    if (prev_out != NULL) {
+        *prev_out = prev;
+    }
+    if (bucket_out != NULL) {
+        *bucket_out = bucket;
+    }
+    return e;
+}
+
+// Hashes a NUL-terminated key of length `len`
+static uint64_t hash_table_hash_string(hash_table_t* ht, const char* key,
+                                       size_t len) {
+    if (ht->hash_n != NULL) {
+        return hash_mix(ht->hash_n(key, len));
+    }
+    if (ht->hash != NULL) {
+        return hash_mix(ht->hash(key));
+    }
+    return hash_wyhash(key, len, ht->seed);
+}
+
+// Hashes a key that is not necessarily NUL-terminated. Returns false if the
+// copy of a long key needed by a string hash function cannot be allocated.
+static bool hash_table_hash_bytes(hash_table_t* ht, const char* key,
+                                  size_t len, uint64_t* out) {
+    if (ht->hash_n != NULL) {
+        *out = hash_mix(ht->hash_n(key, len));
+        return true;
+    }
+    if (ht->hash == NULL) {
+        *out = hash_wyhash(key, len, ht->seed);
+        return true;
+    }
+
+    // String hash functions need a terminated copy of the key
+    char buffer[256];
+    char* tmp = len < sizeof(buffer)
+                    ? buffer
+                    : allocator_alloc(&ht->arena.allocator, len + 1);
+    if (tmp == NULL) {
         return false;
     }
+    memcpy(tmp, key, len);
+    tmp[len] = '\0';
+    *out = hash_mix(ht->hash(tmp));
+    if (tmp != buffer) {
+        allocator_free(&ht->arena.allocator, tmp, len + 1);
+    }
+    return true;
+}
+
+static hash_table_t* hash_table_alloc(size_t size, hash_function* hf,
+                                      hash_function_n* hf_n,
+                                      hash_table_engine_t engine,
+                                      const allocator_t* allocator) {
+    // Resolve the default allocator before the table exists to hold it
+    arena_t arena;
+    arena_init(&arena, allocator);
+    hash_table_t* ht = allocator_calloc(&arena.allocator, 1, sizeof(*ht));
+    if (ht == NULL) {
+        return NULL;
+    }
+    ht->engine = engine;
+    ht->count = 0;
+    ht->arena = arena;
+    ht->hash = hf;
+    ht->hash_n = hf_n;
+    if (hf == NULL && hf_n == NULL) {
+        ht->seed = hash_random_seed();
+    }
+
+    if (engine == HASH_TABLE_OPEN_ADDRESSING) {
+        if (!swiss_init(ht, size)) {
+            allocator_free(&arena.allocator, ht, sizeof(*ht));
+            return NULL;
+        }
+        return ht;
+    }
+
+    ht->size = next_power_of_two(size);
+    if (ht->size == 0) {
+        allocator_free(&arena.allocator, ht, sizeof(*ht));
+        return NULL;
+    }
+    ht->min_size = ht->size;
+    ht->elements =
+        allocator_calloc(&arena.allocator, ht->size, sizeof(entry_t*));
+    if (ht->elements == NULL) {
+        allocator_free(&arena.allocator, ht, sizeof(*ht));
+        return NULL;
+    }
+    ht->old_elements = NULL;
+    ht->old_size = 0;
+    ht->rehash_index = 0;
+    return ht;
+}
+
+// Returns a pointer to the object stored under `key`, creating an entry with
+// a NULL object if the key is not present. The table is probed only once.
+static void** hash_table_find_or_insert_hashed(hash_table_t* ht,
+                                               const char* key, size_t len,
+                                               uint64_t hash, bool* inserted) {
+    if (ht->engine == HASH_TABLE_OPEN_ADDRESSING) {
+        return swiss_find_or_insert(ht, key, len, hash, inserted);
+    }
+
+    hash_table_rehash_step(ht);
+
+    entry_t* e = hash_table_find(ht, key, len, hash, NULL, NULL);
+    if (e != NULL) {
+        *inserted = false;
+        return &e->object;
+    }
 
-    size_t index = hash_table_index(ht, key);
+    size_t index = hash & (ht->size - 1);
 
     // Create a new entry
-    entry_t* e = malloc(sizeof(*e));
-    e->key = malloc(strlen(key) + 1);
-    strcpy(e->key, key);
-    e->object = obj;
+    e = arena_alloc(&ht->arena, entry_size(len));
+    if (e == NULL) {
+        return NULL;
+    }
+    e->hash = hash;
+    e->key_len = len;
+    memcpy(e->key, key, len);
+    e->key[len] = '\0';
+    e->object = NULL;
     e->next = ht->elements[index];
 
     // Insert entry in hash table
     ht->elements[index] = e;
+    ht->count += 1;
+
+    // Entries never move in memory, so growing keeps the pointer valid
+    hash_table_grow_if_needed(ht);
+    *inserted = true;
+    return &e->object;
+}
+
+static bool hash_table_insert_hashed(hash_table_t* ht, const char* key,
+                                     size_t len, uint64_t hash, void* obj) {
+    bool inserted;
+    void** slot =
+        hash_table_find_or_insert_hashed(ht, key, len, hash, &inserted);
 
+    // If the key already exists, do not overwrite
+    if (slot == NULL || !inserted) {
+        return false;
+    }
+    *slot = obj;
     return true;
 }
 
-void* hash_table_lookup(hash_table_t* ht, const char* key) {
-    if (ht == NULL || key == NULL) {
+static void* hash_table_get_or_insert_hashed(hash_table_t* ht,
+                                             const char* key, size_t len,
+                                             uint64_t hash, void* obj) {
+    bool inserted;
+    void** slot =
+        hash_table_find_or_insert_hashed(ht, key, len, hash, &inserted);
+    if (slot == NULL) {
         return NULL;
     }
-
-    size_t index = hash_table_index(ht, key);
-    entry_t* e = ht->elements[index];
-
-    while (e != NULL && strcmp(e->key, key) != 0) {
-        e = e->next;
+    if (inserted) {
+        *slot = obj;
     }
+    return *slot;
+}
 
-    if (e == NULL) {
+static void* hash_table_upsert_hashed(hash_table_t* ht, const char* key,
+                                      size_t len, uint64_t hash, void* obj) {
+    bool inserted;
+    void** slot =
+        hash_table_find_or_insert_hashed(ht, key, len, hash, &inserted);
+    if (slot == NULL) {
         return NULL;
     }
+    void* old = *slot;
+    *slot = obj;
+    return old;
+}
+
+static void* hash_table_lookup_hashed(hash_table_t* ht, const char* key,
+                                      size_t len, uint64_t hash) {
+    void* obj;
+    if (ht->engine == HASH_TABLE_OPEN_ADDRESSING) {
+        obj = swiss_lookup(ht, key, len, hash);
+    } else {
+        hash_table_rehash_step(ht);
+        entry_t* e = hash_table_find(ht, key, len, hash, NULL, NULL);
+        obj = e == NULL ? NULL : e->object;
+    }
 
-    return e->object;
+    HT_STAT_ADD(ht, lookups, 1);
+    HT_STAT_ADD(ht, hits, obj != NULL);
+    return obj;
 }
 
-void* hash_table_delete(hash_table_t* ht, const char* key) {
-    if (ht == NULL || key == NULL) {
-        return NULL;
+static void* hash_table_delete_hashed(hash_table_t* ht, const char* key,
+                                      size_t len, uint64_t hash) {
+    if (ht->engine == HASH_TABLE_OPEN_ADDRESSING) {
+        return swiss_delete(ht, key, len, hash);
     }
 
-    size_t index = hash_table_index(ht, key);
-    entry_t* e = ht->elements[index];
-    entry_t* prev = NULL;
+    hash_table_rehash_step(ht);
 
     // Search the entry to be deleted
-    while (e != NULL && strcmp(e->key, key) != 0) {
-        prev = e;
-        e = e->next;
-    }
+    entry_t* prev = NULL;
+    entry_t** bucket = NULL;
+    entry_t* e = hash_table_find(ht, key, len, hash, &prev, &bucket);
 
     // The entry is not present, return NULL
     if (e == NULL) {
@@ -96,13 +342,339 @@ void* hash_table_delete(hash_table_t* ht, const char* key) {
 
     if (prev == NULL) {
         // Delete from the head of the list
-        ht->elements[index] = e->next;
+        *bucket = e->next;
     } else {
         // Delete from within the list
         prev->next = e->next;
     }
 
     void* obj = e->object;
-    free(e);
+    arena_free(&ht->arena, e, entry_size(e->key_len));
+    ht->count -= 1;
+
+    hash_table_shrink_if_needed(ht);
     return obj;
 }
+
+// Resolves up to HT_BATCH_SIZE lookups whose hashes are already known. All
+// bucket heads are prefetched first, then the first entry of every chain, so
+// that the cache misses of independent lookups overlap.
+static void hash_table_lookup_batch_hashed(hash_table_t* ht,
+                                           const char* const* keys,
+                                           const size_t* lens,
+                                           const uint64_t* hashes, size_t n,
+                                           void** out) {
+    if (ht->engine == HASH_TABLE_OPEN_ADDRESSING) {
+        for (size_t i = 0; i < n; i++) {
+            swiss_prefetch(ht, hashes[i]);
+        }
+        for (size_t i = 0; i < n; i++) {
+            out[i] = swiss_lookup(ht, keys[i], lens[i], hashes[i]);
+            HT_STAT_ADD(ht, hits, out[i] != NULL);
+        }
+        HT_STAT_ADD(ht, lookups, n);
+        return;
+    }
+
+    // Migrate once up front so that bucket arrays stay put during the batch
+    hash_table_rehash_step(ht);
+
+    size_t mask = ht->size - 1;
+    for (size_t i = 0; i < n; i++) {
+        __builtin_prefetch(&ht->elements[hashes[i] & mask]);
+    }
+    for (size_t i = 0; i < n; i++) {
+        entry_t* head = ht->elements[hashes[i] & mask];
+        if (head != NULL) {
+            __builtin_prefetch(head);
+        }
+    }
+    for (size_t i = 0; i < n; i++) {
+        entry_t* e =
+            hash_table_find(ht, keys[i], lens[i], hashes[i], NULL, NULL);
+        out[i] = e == NULL ? NULL : e->object;
+        HT_STAT_ADD(ht, hits, out[i] != NULL);
+    }
+    HT_STAT_ADD(ht, lookups, n);
+}
+
+hash_table_t* hash_table_create(size_t size, hash_function* hf) {
+    return hash_table_alloc(size, hf, NULL, HASH_TABLE_CHAINING, NULL);
+}
+
+hash_table_t* hash_table_create_with_engine(size_t size, hash_function* hf,
+                                            hash_table_engine_t engine) {
+    return hash_table_alloc(size, hf, NULL, engine, NULL);
+}
+
+hash_table_t* hash_table_create_n(size_t size, hash_function_n* hf,
+                                  hash_table_engine_t engine) {
+    return hash_table_alloc(size, NULL, hf, engine, NULL);
+}
+
+hash_table_t* hash_table_create_with_allocator(size_t size, hash_function* hf,
+                                               hash_table_engine_t engine,
+                                               const allocator_t* allocator) {
+    return hash_table_alloc(size, hf, NULL, engine, allocator);
+}
+
+void hash_table_destroy(hash_table_t* ht) {
+    if (ht->engine == HASH_TABLE_OPEN_ADDRESSING) {
+        swiss_free(ht);
+    }
+    // The arena is released last as it holds the allocator
+    allocator_t* allocator = &ht->arena.allocator;
+    if (ht->engine == HASH_TABLE_CHAINING) {
+        allocator_free(allocator, ht->old_elements,
+                       ht->old_size * sizeof(entry_t*));
+        allocator_free(allocator, ht->elements, ht->size * sizeof(entry_t*));
+    }
+    arena_t arena = ht->arena;
+    allocator_free(allocator, ht, sizeof(*ht));
+    arena_release(&arena);
+}
+
+bool hash_table_stats(hash_table_t* ht, hash_table_stats_t* out) {
+    if (ht == NULL || out == NULL) {
+        return false;
+    }
+
+    memset(out, 0, sizeof(*out));
+    out->count = ht->count;
+    out->buckets = ht->size;
+    out->load_factor = (double)ht->count / ht->size;
+    out->bytes_allocated = sizeof(*ht) + ht->arena.bytes;
+
+    if (ht->engine == HASH_TABLE_OPEN_ADDRESSING) {
+        swiss_stats(ht, out);
+    } else {
+        // Buckets of the old array that are not migrated yet count too
+        entry_t** arrays[2] = {ht->elements, ht->old_elements};
+        size_t starts[2] = {0, ht->rehash_index};
+        size_t ends[2] = {ht->size, ht->old_size};
+        for (size_t a = 0; a < 2; a++) {
+            for (size_t i = starts[a]; i < ends[a]; i++) {
+                size_t length = 0;
+                for (entry_t* e = arrays[a][i]; e != NULL; e = e->next) {
+                    length += 1;
+                }
+                histogram_add(out->chain_histogram, length);
+                if (length > out->max_chain) {
+                    out->max_chain = length;
+                }
+            }
+        }
+        out->bytes_allocated += (ht->size + ht->old_size) * sizeof(entry_t*);
+    }
+
+#ifdef HASH_TABLE_STATS
+    out->counters_enabled = true;
+    out->lookups = ht->counters.lookups;
+    out->hits = ht->counters.hits;
+    out->misses = ht->counters.lookups - ht->counters.hits;
+    out->avg_probes = ht->counters.searches == 0
+                          ? 0.0
+                          : (double)ht->counters.probes /
+                                ht->counters.searches;
+#endif
+    return true;
+}
+
+void hash_table_visit(hash_table_t* ht, entry_visitor* visit, void* ctx) {
+    if (ht->engine == HASH_TABLE_OPEN_ADDRESSING) {
+        swiss_visit(ht, visit, ctx);
+        return;
+    }
+    // Buckets of the old array that are not migrated yet hold entries too
+    entry_t** arrays[2] = {ht->elements, ht->old_elements};
+    size_t starts[2] = {0, ht->rehash_index};
+    size_t ends[2] = {ht->size, ht->old_size};
+    for (size_t a = 0; a < 2; a++) {
+        for (size_t i = starts[a]; i < ends[a]; i++) {
+            for (entry_t* e = arrays[a][i]; e != NULL; e = e->next) {
+                visit(ctx, e->key, e->key_len, e->object);
+            }
+        }
+    }
+}
+
+size_t hash_table_size(hash_table_t* ht) {
+    if (ht == NULL) {
+        return 0;
+    }
+    return ht->count;
+}
+
+bool hash_table_insert(hash_table_t* ht, const char* key, void* obj) {
+    if (key == NULL || obj == NULL) {
+        return false;
+    }
+    // Hash the key only once for both the duplicate check and the insertion
+    size_t len = strlen(key);
+    uint64_t hash = hash_table_hash_string(ht, key, len);
+    return hash_table_insert_hashed(ht, key, len, hash, obj);
+}
+
+bool hash_table_insert_n(hash_table_t* ht, const void* key, size_t len,
+                         void* obj) {
+    uint64_t hash;
+    if (ht == NULL || key == NULL || obj == NULL ||
+        !hash_table_hash_bytes(ht, key, len, &hash)) {
+        return false;
+    }
+    return hash_table_insert_hashed(ht, key, len, hash, obj);
+}
+
+void* hash_table_lookup(hash_table_t* ht, const char* key) {
+    if (ht == NULL || key == NULL) {
+        return NULL;
+    }
+    size_t len = strlen(key);
+    uint64_t hash = hash_table_hash_string(ht, key, len);
+    return hash_table_lookup_hashed(ht, key, len, hash);
+}
+
+void* hash_table_lookup_n(hash_table_t* ht, const void* key, size_t len) {
+    uint64_t hash;
+    if (ht == NULL || key == NULL ||
+        !hash_table_hash_bytes(ht, key, len, &hash)) {
+        return NULL;
+    }
+    return hash_table_lookup_hashed(ht, key, len, hash);
+}
+
+void* hash_table_delete(hash_table_t* ht, const char* key) {
+    if (ht == NULL || key == NULL) {
+        return NULL;
+    }
+    size_t len = strlen(key);
+    uint64_t hash = hash_table_hash_string(ht, key, len);
+    return hash_table_delete_hashed(ht, key, len, hash);
+}
+
+void* hash_table_delete_n(hash_table_t* ht, const void* key, size_t len) {
+    uint64_t hash;
+    if (ht == NULL || key == NULL ||
+        !hash_table_hash_bytes(ht, key, len, &hash)) {
+        return NULL;
+    }
+    return hash_table_delete_hashed(ht, key, len, hash);
+}
+
+void* hash_table_get_or_insert(hash_table_t* ht, const char* key, void* obj) {
+    if (ht == NULL || key == NULL || obj == NULL) {
+        return NULL;
+    }
+    size_t len = strlen(key);
+    uint64_t hash = hash_table_hash_string(ht, key, len);
+    return hash_table_get_or_insert_hashed(ht, key, len, hash, obj);
+}
+
+void* hash_table_get_or_insert_n(hash_table_t* ht, const void* key, size_t len,
+                                 void* obj) {
+    uint64_t hash;
+    if (ht == NULL || key == NULL || obj == NULL ||
+        !hash_table_hash_bytes(ht, key, len, &hash)) {
+        return NULL;
+    }
+    return hash_table_get_or_insert_hashed(ht, key, len, hash, obj);
+}
+
+void* hash_table_upsert(hash_table_t* ht, const char* key, void* obj) {
+    if (ht == NULL || key == NULL || obj == NULL) {
+        return NULL;
+    }
+    size_t len = strlen(key);
+    uint64_t hash = hash_table_hash_string(ht, key, len);
+    return hash_table_upsert_hashed(ht, key, len, hash, obj);
+}
+
+void* hash_table_upsert_n(hash_table_t* ht, const void* key, size_t len,
+                          void* obj) {
+    uint64_t hash;
+    if (ht == NULL || key == NULL || obj == NULL ||
+        !hash_table_hash_bytes(ht, key, len, &hash)) {
+        return NULL;
+    }
+    return hash_table_upsert_hashed(ht, key, len, hash, obj);
+}
+
+void** hash_table_emplace(hash_table_t* ht, const char* key, bool* inserted) {
+    if (ht == NULL || key == NULL || inserted == NULL) {
+        return NULL;
+    }
+    size_t len = strlen(key);
+    uint64_t hash = hash_table_hash_string(ht, key, len);
+    return hash_table_find_or_insert_hashed(ht, key, len, hash, inserted);
+}
+
+void** hash_table_emplace_n(hash_table_t* ht, const void* key, size_t len,
+                            bool* inserted) {
+    uint64_t hash;
+    if (ht == NULL || key == NULL || inserted == NULL ||
+        !hash_table_hash_bytes(ht, key, len, &hash)) {
+        return NULL;
+    }
+    return hash_table_find_or_insert_hashed(ht, key, len, hash, inserted);
+}
+
+void hash_table_lookup_batch(hash_table_t* ht, const char* const* keys,
+                             size_t n, void** out) {
+    if (ht == NULL || keys == NULL || out == NULL) {
+        return;
+    }
+
+    const char* batch[HT_BATCH_SIZE];
+    size_t lens[HT_BATCH_SIZE];
+    uint64_t hashes[HT_BATCH_SIZE];
+    for (size_t start = 0; start < n; start += HT_BATCH_SIZE) {
+        size_t count = n - start < HT_BATCH_SIZE ? n - start : HT_BATCH_SIZE;
+        for (size_t i = 0; i < count; i++) {
+            // NULL keys are looked up as empty strings and reported missing
+            batch[i] = keys[start + i] == NULL ? "" : keys[start + i];
+            lens[i] = strlen(batch[i]);
+            hashes[i] = hash_table_hash_string(ht, batch[i], lens[i]);
+        }
+        hash_table_lookup_batch_hashed(ht, batch, lens, hashes, count,
+                                       out + start);
+        for (size_t i = 0; i < count; i++) {
+            if (keys[start + i] == NULL) {
+                out[start + i] = NULL;
+            }
+        }
+    }
+}
+
+void hash_table_lookup_batch_n(hash_table_t* ht, const void* const* keys,
+                               const size_t* lens, size_t n, void** out) {
+    if (ht == NULL || keys == NULL || lens == NULL || out == NULL) {
+        return;
+    }
+
+    const char* batch[HT_BATCH_SIZE];
+    size_t batch_lens[HT_BATCH_SIZE];
+    uint64_t hashes[HT_BATCH_SIZE];
+    bool missing[HT_BATCH_SIZE];
+    for (size_t start = 0; start < n; start += HT_BATCH_SIZE) {
+        size_t count = n - start < HT_BATCH_SIZE ? n - start : HT_BATCH_SIZE;
+        for (size_t i = 0; i < count; i++) {
+            // NULL keys, and keys that cannot be hashed, are looked up as
+            // empty keys and reported missing
+            missing[i] = keys[start + i] == NULL ||
+                         !hash_table_hash_bytes(ht, keys[start + i],
+                                                lens[start + i], &hashes[i]);
+            batch[i] = missing[i] ? "" : keys[start + i];
+            batch_lens[i] = missing[i] ? 0 : lens[start + i];
+            if (missing[i]) {
+                hash_table_hash_bytes(ht, "", 0, &hashes[i]);
+            }
+        }
+        hash_table_lookup_batch_hashed(ht, batch, batch_lens, hashes, count,
+                                       out + start);
+        for (size_t i = 0; i < count; i++) {
+            if (missing[i]) {
+                out[start + i] = NULL;
+            }
+        }
+    }
+}
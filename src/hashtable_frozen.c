@@ -0,0 +1,715 @@
+#include "hashtable_internal.h"
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Average number of keys per bucket of the perfect hash. Larger buckets use
+// less displacement memory but take longer to place.
+#define FROZEN_BUCKET_KEYS 3
+// The keys are placed among 1% more positions than there are slots, which
+// makes placing the last buckets much faster. The keys that land beyond the
+// last slot are then moved to the slots left empty.
+#define FROZEN_EXTRA_POSITIONS(count) ((count) / 100 + 1)
+// Displacements tried for a bucket before starting over with a new seed
+#define FROZEN_MAX_DISPLACEMENT (1u << 24)
+#define FROZEN_MAX_SEEDS 8
+
+// Snapshot files start with a header followed by the displacements, the
+// remapped positions, the slots and the records, in the native byte order.
+// Every section starts at a multiple of FROZEN_FILE_ALIGN bytes.
+#define FROZEN_FILE_MAGIC "DSFROZEN"
+// Incremented on any change to the layout or to the hash functions
+#define FROZEN_FILE_VERSION 1
+#define FROZEN_FILE_BYTE_ORDER 0x01020304u
+#define FROZEN_FILE_ALIGN 8
+#define FROZEN_FILE_CHECKSUM_SEED 0x6a09e667f3bcc908ULL
+
+typedef struct frozen_file_header_t {
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order;
+    uint64_t file_size;
+    // Hash of the header, with this field zeroed, and of the rest of the file
+    uint64_t checksum;
+    uint64_t count;
+    uint64_t num_buckets;
+    uint64_t num_positions;
+    uint64_t seed;
+    uint64_t data_size;
+} frozen_file_header_t;
+
+// Slot of a snapshot file. The key is stored at `key_offset` in the records
+// section, followed by the value at the next aligned offset.
+typedef struct frozen_file_slot_t {
+    uint64_t key_offset;
+    uint32_t key_len;
+    uint32_t value_size;
+} frozen_file_slot_t;
+
+// Keys are packed in slot order in a single buffer. Lookups read the slot
+// chosen by the perfect hash, then compare the key bytes it points to.
+typedef struct frozen_slot_t {
+    uint32_t key_offset;
+    uint32_t key_len;
+    void* object;
+} frozen_slot_t;
+
+typedef struct _frozen_hash_table {
+    size_t count;
+    size_t num_buckets;
+    size_t num_positions;
+    uint64_t seed;
+    // Displacement of each bucket, selecting the position hash of its keys
+    uint32_t* displacements;
+    // Slot of each position past the last slot
+    uint32_t* remap;
+    frozen_slot_t* slots;
+    char* keys;
+    size_t keys_size;
+    allocator_t allocator;
+    // Tables opened from a snapshot file point into its mapping, and keep
+    // file slots and records instead of slots and keys
+    void* mapping;
+    size_t mapping_size;
+    const frozen_file_slot_t* file_slots;
+    const char* records;
+} frozen_hash_table_t;
+
+// Maps a 64-bit hash uniformly onto [0, n) without a division
+static inline size_t fast_range(uint64_t hash, size_t n) {
+    return (size_t)(((unsigned __int128)hash * n) >> 64);
+}
+
+static inline size_t frozen_bucket(const frozen_hash_table_t* ft,
+                                   uint64_t hash) {
+    return fast_range(hash, ft->num_buckets);
+}
+
+static inline size_t frozen_position(const frozen_hash_table_t* ft,
+                                     uint64_t hash, uint32_t displacement) {
+    uint64_t h = hash ^ (displacement * 0x9e3779b97f4a7c15ULL);
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return fast_range(h, ft->num_positions);
+}
+
+typedef struct frozen_key_t {
+    const char* key;
+    size_t len;
+    void* object;
+    uint64_t hash;
+} frozen_key_t;
+
+typedef struct collect_ctx_t {
+    frozen_key_t* keys;
+    size_t count;
+    size_t keys_size;
+} collect_ctx_t;
+
+static void collect_entry(void* ptr, const char* key, size_t len,
+                          void* object) {
+    collect_ctx_t* ctx = ptr;
+    frozen_key_t* k = &ctx->keys[ctx->count++];
+    k->key = key;
+    k->len = len;
+    k->object = object;
+    ctx->keys_size += len;
+}
+
+// Finds a displacement for every bucket such that all keys land in distinct
+// positions, then maps the positions past the last slot to the free slots.
+// Stores the slot of each key in `key_slots`. Buckets are placed from the
+// largest down, while the table is still mostly empty. Returns false if some
+// bucket could not be placed.
+static bool frozen_place(frozen_hash_table_t* ft, frozen_key_t* keys,
+                         size_t* key_slots) {
+    size_t n = ft->count;
+    size_t nb = ft->num_buckets;
+    // Keys of bucket b are order[bucket_start[b]] to order[bucket_start[b+1]]
+    size_t* bucket_start = calloc(nb + 1, sizeof(size_t));
+    size_t* order = malloc((n + 1) * sizeof(size_t));
+    size_t* by_size = malloc((nb + 1) * sizeof(size_t));
+    size_t m = ft->num_positions;
+    uint64_t* taken = calloc(m / 64 + 1, sizeof(uint64_t));
+    size_t* counts = NULL;
+    bool ok = false;
+    if (bucket_start == NULL || order == NULL || by_size == NULL ||
+        taken == NULL) {
+        goto out;
+    }
+
+    // Group the keys by bucket with a counting sort
+    size_t max_size = 0;
+    for (size_t i = 0; i < n; i++) {
+        keys[i].hash = hash_wyhash(keys[i].key, keys[i].len, ft->seed);
+        bucket_start[frozen_bucket(ft, keys[i].hash) + 1] += 1;
+    }
+    for (size_t b = 0; b < nb; b++) {
+        size_t size = bucket_start[b + 1];
+        max_size = size > max_size ? size : max_size;
+        bucket_start[b + 1] += bucket_start[b];
+    }
+    for (size_t i = n; i-- > 0;) {
+        order[--bucket_start[frozen_bucket(ft, keys[i].hash) + 1]] = i;
+    }
+    for (size_t b = 0; b < nb; b++) {
+        bucket_start[b + 1] = b + 1 < nb ? bucket_start[b + 2] : n;
+    }
+
+    // Sort the buckets by decreasing size, again with a counting sort
+    counts = calloc(max_size + 2, sizeof(size_t));
+    if (counts == NULL) {
+        goto out;
+    }
+    for (size_t b = 0; b < nb; b++) {
+        counts[max_size - (bucket_start[b + 1] - bucket_start[b]) + 1] += 1;
+    }
+    for (size_t s = 0; s <= max_size; s++) {
+        counts[s + 1] += counts[s];
+    }
+    for (size_t b = 0; b < nb; b++) {
+        by_size[counts[max_size - (bucket_start[b + 1] - bucket_start[b])]++] =
+            b;
+    }
+
+    ok = true;
+    for (size_t i = 0; ok && i < nb; i++) {
+        size_t b = by_size[i];
+        size_t start = bucket_start[b];
+        size_t end = bucket_start[b + 1];
+        uint32_t d = 0;
+        while (start < end) {
+            // Claim slots until one is taken, then roll back and retry
+            size_t placed = start;
+            while (placed < end) {
+                size_t slot = frozen_position(ft, keys[order[placed]].hash, d);
+                if (taken[slot / 64] & (1ULL << (slot % 64))) {
+                    break;
+                }
+                taken[slot / 64] |= 1ULL << (slot % 64);
+                key_slots[order[placed]] = slot;
+                placed += 1;
+            }
+            if (placed == end) {
+                break;
+            }
+            while (placed-- > start) {
+                size_t slot = key_slots[order[placed]];
+                taken[slot / 64] &= ~(1ULL << (slot % 64));
+            }
+            if (++d == FROZEN_MAX_DISPLACEMENT) {
+                ok = false;
+                break;
+            }
+        }
+        ft->displacements[b] = d;
+    }
+
+    if (ok) {
+        size_t free_slot = 0;
+        for (size_t p = n; p < m; p++) {
+            if (taken[p / 64] & (1ULL << (p % 64))) {
+                while (taken[free_slot / 64] & (1ULL << (free_slot % 64))) {
+                    free_slot += 1;
+                }
+                ft->remap[p - n] = (uint32_t)free_slot++;
+            } else {
+                ft->remap[p - n] = 0;
+            }
+        }
+        for (size_t i = 0; i < n; i++) {
+            if (key_slots[i] >= n) {
+                key_slots[i] = ft->remap[key_slots[i] - n];
+            }
+        }
+    }
+
+out:
+    free(bucket_start);
+    free(order);
+    free(by_size);
+    free(taken);
+    free(counts);
+    return ok;
+}
+
+// Collects the keys of `ht` and places them with the perfect hash. Returns a
+// table that only holds the displacements and remapped positions, and the
+// keys in `*keys`, key `i` belonging to slot `(*key_slots)[i]`. The caller
+// frees both arrays.
+static frozen_hash_table_t* frozen_build(hash_table_t* ht, frozen_key_t** keys,
+                                         size_t** key_slots) {
+    const allocator_t* allocator = &ht->arena.allocator;
+    frozen_hash_table_t* ft = allocator_calloc(allocator, 1, sizeof(*ft));
+    if (ft == NULL) {
+        return NULL;
+    }
+    // Set before any failure, as destroying the table frees through it
+    ft->allocator = *allocator;
+    collect_ctx_t ctx = {malloc((ht->count + 1) * sizeof(frozen_key_t)), 0,
+                         0};
+    *key_slots = malloc((ht->count + 1) * sizeof(size_t));
+    if (ctx.keys == NULL || *key_slots == NULL) {
+        goto fail;
+    }
+    hash_table_visit(ht, collect_entry, &ctx);
+    // Remapped positions are stored as 32-bit slot numbers
+    if (ctx.count > UINT32_MAX) {
+        goto fail;
+    }
+
+    ft->count = ctx.count;
+    ft->num_buckets = (ctx.count + FROZEN_BUCKET_KEYS - 1) / FROZEN_BUCKET_KEYS;
+    ft->num_positions = ctx.count + FROZEN_EXTRA_POSITIONS(ctx.count);
+    ft->keys_size = ctx.keys_size;
+    ft->displacements =
+        allocator_alloc(allocator, ft->num_buckets * sizeof(uint32_t) + 1);
+    ft->remap = allocator_alloc(
+        allocator, FROZEN_EXTRA_POSITIONS(ctx.count) * sizeof(uint32_t));
+    if (ft->displacements == NULL || ft->remap == NULL) {
+        goto fail;
+    }
+
+    bool placed = false;
+    for (size_t s = 0; s < FROZEN_MAX_SEEDS && !placed; s++) {
+        ft->seed = hash_random_seed();
+        placed = frozen_place(ft, ctx.keys, *key_slots);
+    }
+    if (!placed) {
+        goto fail;
+    }
+    *keys = ctx.keys;
+    return ft;
+
+fail:
+    free(ctx.keys);
+    free(*key_slots);
+    *key_slots = NULL;
+    frozen_hash_table_destroy(ft);
+    return NULL;
+}
+
+frozen_hash_table_t* hash_table_freeze(hash_table_t* ht) {
+    if (ht == NULL) {
+        return NULL;
+    }
+    frozen_key_t* keys;
+    size_t* key_slots;
+    frozen_hash_table_t* ft = frozen_build(ht, &keys, &key_slots);
+    if (ft == NULL) {
+        return NULL;
+    }
+    // Slots address the key buffer with 32-bit offsets
+    if (ft->keys_size > UINT32_MAX) {
+        goto fail;
+    }
+    ft->slots = allocator_alloc(&ft->allocator,
+                                ft->count * sizeof(frozen_slot_t) + 1);
+    ft->keys = allocator_alloc(&ft->allocator, ft->keys_size + 1);
+    if (ft->slots == NULL || ft->keys == NULL) {
+        goto fail;
+    }
+
+    // Pack the keys in slot order, so that a scan of the slots reads the key
+    // buffer sequentially. The key offset field first holds the key index.
+    for (size_t i = 0; i < ft->count; i++) {
+        ft->slots[key_slots[i]].key_offset = (uint32_t)i;
+    }
+    size_t offset = 0;
+    for (size_t s = 0; s < ft->count; s++) {
+        frozen_key_t* k = &keys[ft->slots[s].key_offset];
+        memcpy(ft->keys + offset, k->key, k->len);
+        ft->slots[s].key_len = (uint32_t)k->len;
+        ft->slots[s].object = k->object;
+        ft->slots[s].key_offset = (uint32_t)offset;
+        offset += k->len;
+    }
+
+    free(keys);
+    free(key_slots);
+    return ft;
+
+fail:
+    free(keys);
+    free(key_slots);
+    frozen_hash_table_destroy(ft);
+    return NULL;
+}
+
+void frozen_hash_table_destroy(frozen_hash_table_t* ft) {
+    if (ft == NULL) {
+        return;
+    }
+    if (ft->mapping != NULL) {
+        munmap(ft->mapping, ft->mapping_size);
+        free(ft);
+        return;
+    }
+    allocator_t allocator = ft->allocator;
+    allocator_free(&allocator, ft->displacements,
+                   ft->num_buckets * sizeof(uint32_t) + 1);
+    allocator_free(&allocator, ft->remap,
+                   FROZEN_EXTRA_POSITIONS(ft->count) * sizeof(uint32_t));
+    allocator_free(&allocator, ft->slots,
+                   ft->count * sizeof(frozen_slot_t) + 1);
+    allocator_free(&allocator, ft->keys, ft->keys_size + 1);
+    allocator_free(&allocator, ft, sizeof(*ft));
+}
+
+size_t frozen_hash_table_size(const frozen_hash_table_t* ft) {
+    if (ft == NULL) {
+        return 0;
+    }
+    return ft->count;
+}
+
+size_t frozen_hash_table_bytes(const frozen_hash_table_t* ft) {
+    if (ft == NULL) {
+        return 0;
+    }
+    if (ft->mapping != NULL) {
+        return sizeof(*ft) + ft->mapping_size;
+    }
+    return sizeof(*ft) +
+           (ft->num_buckets + FROZEN_EXTRA_POSITIONS(ft->count)) *
+               sizeof(uint32_t) +
+           ft->count * sizeof(frozen_slot_t) + ft->keys_size;
+}
+
+static inline size_t frozen_align(size_t offset) {
+    return (offset + FROZEN_FILE_ALIGN - 1) & ~(size_t)(FROZEN_FILE_ALIGN - 1);
+}
+
+// Finds the object, or the value bytes of a mapped table, stored under a key
+static void* frozen_find(const frozen_hash_table_t* ft, const void* key,
+                         size_t len, size_t* value_size) {
+    if (ft == NULL || key == NULL || ft->count == 0) {
+        return NULL;
+    }
+    uint64_t hash = hash_wyhash(key, len, ft->seed);
+    uint32_t displacement = ft->displacements[frozen_bucket(ft, hash)];
+    size_t pos = frozen_position(ft, hash, displacement);
+    if (pos >= ft->count) {
+        pos = ft->remap[pos - ft->count];
+    }
+    // Keys that are not in the table still map to some slot
+    if (ft->mapping != NULL) {
+        const frozen_file_slot_t* slot = &ft->file_slots[pos];
+        if (slot->key_len != len ||
+            memcmp(ft->records + slot->key_offset, key, len) != 0) {
+            return NULL;
+        }
+        if (value_size != NULL) {
+            *value_size = slot->value_size;
+        }
+        return (void*)(ft->records + frozen_align(slot->key_offset + len));
+    }
+    const frozen_slot_t* slot = &ft->slots[pos];
+    if (slot->key_len != len ||
+        memcmp(ft->keys + slot->key_offset, key, len) != 0) {
+        return NULL;
+    }
+    if (value_size != NULL) {
+        *value_size = 0;
+    }
+    return slot->object;
+}
+
+void* frozen_hash_table_lookup_n(const frozen_hash_table_t* ft,
+                                 const void* key, size_t len) {
+    return frozen_find(ft, key, len, NULL);
+}
+
+void* frozen_hash_table_lookup(const frozen_hash_table_t* ft,
+                               const char* key) {
+    if (key == NULL) {
+        return NULL;
+    }
+    return frozen_find(ft, key, strlen(key), NULL);
+}
+
+const void* frozen_hash_table_lookup_value(const frozen_hash_table_t* ft,
+                                           const void* key, size_t len,
+                                           size_t* size) {
+    return frozen_find(ft, key, len, size);
+}
+
+// Computes the offsets of the sections of a snapshot file and its total size.
+// Returns false if the sizes overflow.
+static bool frozen_file_layout(const frozen_file_header_t* header,
+                               size_t offsets[4], size_t* file_size) {
+    uint64_t limit = SIZE_MAX / 32;
+    if (header->count > limit || header->num_buckets > limit ||
+        header->num_positions > limit || header->data_size > limit ||
+        header->num_positions < header->count) {
+        return false;
+    }
+    size_t sizes[4] = {
+        header->num_buckets * sizeof(uint32_t),
+        (header->num_positions - header->count) * sizeof(uint32_t),
+        header->count * sizeof(frozen_file_slot_t),
+        header->data_size,
+    };
+    size_t offset = frozen_align(sizeof(frozen_file_header_t));
+    for (size_t i = 0; i < 4; i++) {
+        offsets[i] = offset;
+        offset = frozen_align(offset + sizes[i]);
+    }
+    *file_size = offset;
+    return true;
+}
+
+static uint64_t frozen_file_checksum(const char* file, size_t file_size) {
+    frozen_file_header_t header;
+    memcpy(&header, file, sizeof(header));
+    header.checksum = 0;
+    uint64_t hash =
+        hash_wyhash(&header, sizeof(header), FROZEN_FILE_CHECKSUM_SEED);
+    return hash_wyhash(file + sizeof(header), file_size - sizeof(header),
+                       hash);
+}
+
+// Key and serialized value stored in one slot of a snapshot file
+typedef struct frozen_record_t {
+    const frozen_key_t* key;
+    const void* data;
+    size_t size;
+} frozen_record_t;
+
+// Fills a mapping of the snapshot file of the placement `ft`, whose records
+// are `records` in slot order
+static void frozen_file_write(const frozen_hash_table_t* ft,
+                              const frozen_record_t* records,
+                              frozen_file_header_t* header,
+                              const size_t offsets[4], char* file,
+                              size_t file_size) {
+    memcpy(file, header, sizeof(*header));
+    memcpy(file + offsets[0], ft->displacements,
+           ft->num_buckets * sizeof(uint32_t));
+    memcpy(file + offsets[1], ft->remap,
+           (ft->num_positions - ft->count) * sizeof(uint32_t));
+    frozen_file_slot_t* slots = (frozen_file_slot_t*)(file + offsets[2]);
+    char* data = file + offsets[3];
+    uint64_t offset = 0;
+    for (size_t s = 0; s < ft->count; s++) {
+        const frozen_record_t* r = &records[s];
+        slots[s].key_offset = offset;
+        slots[s].key_len = (uint32_t)r->key->len;
+        slots[s].value_size = (uint32_t)r->size;
+        memcpy(data + offset, r->key->key, r->key->len);
+        offset = frozen_align(offset + r->key->len);
+        memcpy(data + offset, r->data, r->size);
+        offset = frozen_align(offset + r->size);
+    }
+    header->checksum = frozen_file_checksum(file, file_size);
+    memcpy(file, header, sizeof(*header));
+}
+
+// Flushes the directory entry of `path`, so that a file renamed to it
+// survives a crash
+static bool frozen_sync_directory(const char* path) {
+    const char* slash = strrchr(path, '/');
+    char* dir = slash == NULL ? strdup(".") : strndup(path, slash - path + 1);
+    if (dir == NULL) {
+        return false;
+    }
+    int fd = open(dir, O_RDONLY | O_DIRECTORY);
+    free(dir);
+    if (fd < 0) {
+        return false;
+    }
+    bool ok = fsync(fd) == 0;
+    return close(fd) == 0 && ok;
+}
+
+static pthread_once_t frozen_umask_once = PTHREAD_ONCE_INIT;
+static mode_t frozen_umask;
+
+// The umask can only be read by replacing it, which races with other threads
+// creating files, so it is read once rather than on every save
+static void frozen_read_umask() {
+    frozen_umask = umask(0);
+    umask(frozen_umask);
+}
+
+bool hash_table_save(hash_table_t* ht, const char* path,
+                     hash_table_serializer* serialize) {
+    if (ht == NULL || path == NULL || serialize == NULL) {
+        return false;
+    }
+    // Write the keys straight from the table in the order of the placement,
+    // with 64-bit offsets, rather than from a frozen copy of them
+    frozen_key_t* keys = NULL;
+    size_t* key_slots = NULL;
+    frozen_hash_table_t* ft = frozen_build(ht, &keys, &key_slots);
+    frozen_record_t* records = malloc((hash_table_size(ht) + 1) *
+                                      sizeof(frozen_record_t));
+    size_t tmp_size = strlen(path) + sizeof(".XXXXXX");
+    char* tmp_path = malloc(tmp_size);
+    bool ok = ft != NULL && records != NULL && tmp_path != NULL;
+
+    // Serialize every value first, to size the file
+    frozen_file_header_t header = {0};
+    for (size_t i = 0; ok && i < ft->count; i++) {
+        frozen_record_t* r = &records[key_slots[i]];
+        r->key = &keys[i];
+        r->size = 0;
+        r->data = serialize(keys[i].object, &r->size);
+        ok = r->data != NULL && r->size <= UINT32_MAX &&
+             keys[i].len <= UINT32_MAX;
+        header.data_size += frozen_align(keys[i].len) + frozen_align(r->size);
+    }
+    size_t offsets[4];
+    size_t file_size = 0;
+    if (ok) {
+        memcpy(header.magic, FROZEN_FILE_MAGIC, sizeof(header.magic));
+        header.version = FROZEN_FILE_VERSION;
+        header.byte_order = FROZEN_FILE_BYTE_ORDER;
+        header.count = ft->count;
+        header.num_buckets = ft->num_buckets;
+        header.num_positions = ft->num_positions;
+        header.seed = ft->seed;
+        ok = frozen_file_layout(&header, offsets, &file_size);
+        header.file_size = file_size;
+    }
+
+    // Write to a uniquely named file in the same directory, renamed over
+    // `path` once complete, so that readers never map a partially written
+    // file and concurrent saves do not write to the same file
+    int fd = -1;
+    if (ok) {
+        snprintf(tmp_path, tmp_size, "%s.XXXXXX", path);
+        fd = mkstemp(tmp_path);
+        // mkstemp() creates the file readable by its owner only; give it
+        // the permissions of a file created with open() instead. Reserve
+        // the blocks up front: writing through the mapping to a sparse file
+        // would raise SIGBUS instead of failing on a full disk.
+        pthread_once(&frozen_umask_once, frozen_read_umask);
+        ok = fd >= 0 && fchmod(fd, 0666 & ~frozen_umask) == 0 &&
+             posix_fallocate(fd, 0, (off_t)file_size) == 0;
+    }
+    if (ok) {
+        char* file =
+            mmap(NULL, file_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        ok = file != MAP_FAILED;
+        if (ok) {
+            frozen_file_write(ft, records, &header, offsets, file, file_size);
+            ok = munmap(file, file_size) == 0;
+        }
+        ok = ok && fsync(fd) == 0;
+    }
+    if (fd >= 0) {
+        ok = close(fd) == 0 && ok;
+        ok = ok && rename(tmp_path, path) == 0;
+        if (!ok) {
+            unlink(tmp_path);
+        }
+    }
+    ok = ok && frozen_sync_directory(path);
+
+    free(tmp_path);
+    free(records);
+    free(keys);
+    free(key_slots);
+    frozen_hash_table_destroy(ft);
+    return ok;
+}
+
+// Checks that every lookup in a snapshot file stays within the file: the
+// checksum only detects accidental corruption, not inconsistent contents
+static bool frozen_file_validate(const frozen_file_header_t* header,
+                                 const char* file, const size_t offsets[4]) {
+    size_t count = header->count;
+    if (header->num_buckets !=
+            (count + FROZEN_BUCKET_KEYS - 1) / FROZEN_BUCKET_KEYS ||
+        header->num_positions != count + FROZEN_EXTRA_POSITIONS(count)) {
+        return false;
+    }
+    const uint32_t* displacements = (const uint32_t*)(file + offsets[0]);
+    for (size_t b = 0; b < header->num_buckets; b++) {
+        if (displacements[b] >= FROZEN_MAX_DISPLACEMENT) {
+            return false;
+        }
+    }
+    // Empty tables answer every lookup without reading the positions
+    const uint32_t* remap = (const uint32_t*)(file + offsets[1]);
+    for (size_t i = 0; count > 0 && i < header->num_positions - count; i++) {
+        if (remap[i] >= count) {
+            return false;
+        }
+    }
+    const frozen_file_slot_t* slots =
+        (const frozen_file_slot_t*)(file + offsets[2]);
+    uint64_t data_size = header->data_size;
+    for (size_t s = 0; s < count; s++) {
+        uint64_t key_offset = slots[s].key_offset;
+        if (key_offset > data_size ||
+            slots[s].key_len > data_size - key_offset) {
+            return false;
+        }
+        uint64_t value_offset = frozen_align(key_offset + slots[s].key_len);
+        if (value_offset > data_size ||
+            slots[s].value_size > data_size - value_offset) {
+            return false;
+        }
+    }
+    return true;
+}
+
+frozen_hash_table_t* hash_table_open_mmap(const char* path) {
+    if (path == NULL) {
+        return NULL;
+    }
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return NULL;
+    }
+    struct stat st;
+    char* file = MAP_FAILED;
+    if (fstat(fd, &st) == 0 &&
+        (size_t)st.st_size >= sizeof(frozen_file_header_t)) {
+        file = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    close(fd);
+    if (file == MAP_FAILED) {
+        return NULL;
+    }
+
+    // Reject files of another format, version or byte order, then files
+    // that were truncated, corrupted or point outside of themselves
+    size_t file_size = st.st_size;
+    frozen_file_header_t header;
+    memcpy(&header, file, sizeof(header));
+    size_t offsets[4];
+    size_t expected_size;
+    frozen_hash_table_t* ft = NULL;
+    if (memcmp(header.magic, FROZEN_FILE_MAGIC, sizeof(header.magic)) == 0 &&
+        header.version == FROZEN_FILE_VERSION &&
+        header.byte_order == FROZEN_FILE_BYTE_ORDER &&
+        header.file_size == file_size &&
+        frozen_file_layout(&header, offsets, &expected_size) &&
+        expected_size == file_size &&
+        header.checksum == frozen_file_checksum(file, file_size) &&
+        frozen_file_validate(&header, file, offsets)) {
+        ft = calloc(1, sizeof(*ft));
+    }
+    if (ft == NULL) {
+        munmap(file, file_size);
+        return NULL;
+    }
+    ft->count = header.count;
+    ft->num_buckets = header.num_buckets;
+    ft->num_positions = header.num_positions;
+    ft->seed = header.seed;
+    ft->displacements = (uint32_t*)(file + offsets[0]);
+    ft->remap = (uint32_t*)(file + offsets[1]);
+    ft->file_slots = (const frozen_file_slot_t*)(file + offsets[2]);
+    ft->records = file + offsets[3];
+    ft->mapping = file;
+    ft->mapping_size = file_size;
+    return ft;
+}
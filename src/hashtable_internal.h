@@ -0,0 +1,137 @@
+/**
+ * @file hashtable_internal.h
+ * @brief Private definitions shared by the hash table engines.
+ */
+
+#ifndef HASHTABLE_INTERNAL_H
+#define HASHTABLE_INTERNAL_H
+
+#include "arena.h"
+#include "hashfunctions.h"
+#include "hashtable.h"
+
+// Chained entries are allocated from the table's arena together with the
+// NUL-terminated key bytes that follow them.
+typedef struct entry_t {
+    struct entry_t* next;
+    uint64_t hash;
+    void* object;
+    size_t key_len;
+    char key[];
+} entry_t;
+
+typedef struct slot_t {
+    uint64_t hash;
+    size_t key_len;
+    char* key;
+    void* object;
+} slot_t;
+
+#ifdef HASH_TABLE_STATS
+#define HT_STAT_ADD(ht, field, n) ((ht)->counters.field += (n))
+#else
+#define HT_STAT_ADD(ht, field, n) ((void)0)
+#endif
+
+// Cumulative operation counters, see hash_table_stats_t
+typedef struct counters_t {
+    uint64_t lookups;
+    uint64_t hits;
+    uint64_t searches;
+    uint64_t probes;
+} counters_t;
+
+typedef struct _hash_table {
+    hash_table_engine_t engine;
+    size_t size;
+    size_t min_size;
+    size_t count;
+    // At most one of the two hash functions is set. If neither is, keys are
+    // hashed with the bundled seeded hash function.
+    hash_function* hash;
+    hash_function_n* hash_n;
+    uint64_t seed;
+
+    // Separate chaining engine. While a rehash is in progress, entries are
+    // migrated bucket by bucket from `old_elements` into `elements`. Buckets
+    // below `rehash_index` have already been emptied.
+    entry_t** elements;
+    entry_t** old_elements;
+    size_t old_size;
+    size_t rehash_index;
+
+    // Open addressing engine. `ctrl` holds one control byte per slot plus a
+    // copy of the first group so that group loads never wrap around.
+    uint8_t* ctrl;
+    slot_t* slots;
+    size_t growth_left;
+
+    // Storage for entries and keys, released in bulk on destroy
+    arena_t arena;
+
+#ifdef HASH_TABLE_STATS
+    counters_t counters;
+#endif
+} hash_table_t;
+
+// Scrambles the user-provided hash so that the low bits can be used directly
+// as an index even for weak hash functions.
+static inline uint64_t hash_mix(uint64_t h) {
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    return h;
+}
+
+// Compares the cached hash and length first so that key bytes are only
+// touched when the entry is very likely to match.
+static inline bool key_matches(uint64_t stored_hash, size_t stored_len,
+                               const char* stored_key, uint64_t hash,
+                               size_t len, const char* key) {
+    return stored_hash == hash && stored_len == len &&
+           memcmp(stored_key, key, len) == 0;
+}
+
+static inline size_t entry_size(size_t key_len) {
+    return sizeof(entry_t) + key_len + 1;
+}
+
+static inline void histogram_add(size_t* histogram, size_t length) {
+    if (length >= HASH_TABLE_HISTOGRAM_SIZE) {
+        length = HASH_TABLE_HISTOGRAM_SIZE - 1;
+    }
+    histogram[length] += 1;
+}
+
+// Smallest power of two not less than `n`, or 0 if it does not fit in a size_t
+static inline size_t next_power_of_two(size_t n) {
+    if (n > (SIZE_MAX >> 1) + 1) {
+        return 0;
+    }
+    size_t p = 1;
+    while (p < n) {
+        p <<= 1;
+    }
+    return p;
+}
+
+// Callback receiving every entry of a table
+typedef void entry_visitor(void* ctx, const char* key, size_t len,
+                           void* object);
+
+// Calls `visit` on every entry of the table, in no particular order
+void hash_table_visit(hash_table_t* ht, entry_visitor* visit, void* ctx);
+
+bool swiss_init(hash_table_t* ht, size_t size);
+void swiss_free(hash_table_t* ht);
+void** swiss_find_or_insert(hash_table_t* ht, const char* key, size_t len,
+                           uint64_t hash, bool* inserted);
+void swiss_stats(hash_table_t* ht, hash_table_stats_t* out);
+void swiss_visit(hash_table_t* ht, entry_visitor* visit, void* ctx);
+void swiss_prefetch(hash_table_t* ht, uint64_t hash);
+void* swiss_lookup(hash_table_t* ht, const char* key, size_t len,
+                   uint64_t hash);
+void* swiss_delete(hash_table_t* ht, const char* key, size_t len,
+                   uint64_t hash);
+
+#endif // HASHTABLE_INTERNAL_H
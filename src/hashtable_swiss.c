@@ -0,0 +1,349 @@
+#include "hashtable_internal.h"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+// Number of control bytes compared at once
+#define GROUP_WIDTH 16
+// Maximum fraction of slots that may hold entries or tombstones
+#define SWISS_MAX_LOAD_NUM 7
+#define SWISS_MAX_LOAD_DEN 8
+// Minimum fraction of slots that must hold entries before shrinking
+#define SWISS_MIN_LOAD_DEN 8
+
+// Control byte values. Full slots store the low 7 bits of the hash, so only
+// empty and deleted slots have the high bit set.
+#define CTRL_EMPTY ((uint8_t)0x80)
+#define CTRL_DELETED ((uint8_t)0xFE)
+
+typedef uint32_t bitmask_t;
+
+static inline uint8_t hash_h2(uint64_t hash) { return hash & 0x7f; }
+
+static inline size_t hash_h1(uint64_t hash) { return hash >> 7; }
+
+// Returns a bitmask of the slots in the group whose control byte is `c`
+static inline bitmask_t group_match(const uint8_t* ctrl, uint8_t c) {
+#ifdef __SSE2__
+    __m128i group = _mm_loadu_si128((const __m128i*)ctrl);
+    __m128i match = _mm_cmpeq_epi8(group, _mm_set1_epi8((char)c));
+    return (bitmask_t)_mm_movemask_epi8(match);
+#else
+    bitmask_t mask = 0;
+    for (int i = 0; i < GROUP_WIDTH; i++) {
+        if (ctrl[i] == c) {
+            mask |= (bitmask_t)1 << i;
+        }
+    }
+    return mask;
+#endif
+}
+
+// Returns a bitmask of the slots in the group that are empty or deleted
+static inline bitmask_t group_match_available(const uint8_t* ctrl) {
+#ifdef __SSE2__
+    __m128i group = _mm_loadu_si128((const __m128i*)ctrl);
+    return (bitmask_t)_mm_movemask_epi8(group);
+#else
+    bitmask_t mask = 0;
+    for (int i = 0; i < GROUP_WIDTH; i++) {
+        if (ctrl[i] & 0x80) {
+            mask |= (bitmask_t)1 << i;
+        }
+    }
+    return mask;
+#endif
+}
+
+static inline void set_ctrl(hash_table_t* ht, size_t index, uint8_t c) {
+    ht->ctrl[index] = c;
+    // Keep the cloned first group in sync
+    if (index < GROUP_WIDTH) {
+        ht->ctrl[ht->size + index] = c;
+    }
+}
+
+// Groups are visited with triangular strides, which covers every group of a
+// power-of-two sized table exactly once.
+static inline size_t probe_next(size_t pos, size_t* stride, size_t mask) {
+    *stride += GROUP_WIDTH;
+    return (pos + *stride) & mask;
+}
+
+// Returns the first empty or deleted slot in the probe sequence of `hash`
+static size_t swiss_find_available(hash_table_t* ht, uint64_t hash) {
+    size_t mask = ht->size - 1;
+    size_t pos = hash_h1(hash) & mask;
+    size_t stride = 0;
+    while (true) {
+        bitmask_t available = group_match_available(&ht->ctrl[pos]);
+        if (available != 0) {
+            return (pos + __builtin_ctz(available)) & mask;
+        }
+        pos = probe_next(pos, &stride, mask);
+    }
+}
+
+// Returns the index of the slot holding `key`, or `ht->size` if not found
+static size_t swiss_find(hash_table_t* ht, const char* key, size_t len,
+                         uint64_t hash) {
+    size_t mask = ht->size - 1;
+    size_t pos = hash_h1(hash) & mask;
+    size_t stride = 0;
+    uint8_t h2 = hash_h2(hash);
+    HT_STAT_ADD(ht, searches, 1);
+    while (true) {
+        HT_STAT_ADD(ht, probes, 1);
+        const uint8_t* group = &ht->ctrl[pos];
+        bitmask_t match = group_match(group, h2);
+        while (match != 0) {
+            size_t index = (pos + __builtin_ctz(match)) & mask;
+            slot_t* slot = &ht->slots[index];
+            if (key_matches(slot->hash, slot->key_len, slot->key, hash, len,
+                            key)) {
+                return index;
+            }
+            match &= match - 1;
+        }
+        // An empty slot terminates the probe sequence
+        if (group_match(group, CTRL_EMPTY) != 0) {
+            return ht->size;
+        }
+        pos = probe_next(pos, &stride, mask);
+    }
+}
+
+static void swiss_free_arrays(hash_table_t* ht, uint8_t* ctrl, slot_t* slots,
+                              size_t capacity) {
+    allocator_free(&ht->arena.allocator, ctrl, capacity + GROUP_WIDTH);
+    allocator_free(&ht->arena.allocator, slots, capacity * sizeof(slot_t));
+}
+
+static bool swiss_alloc(hash_table_t* ht, size_t capacity) {
+    allocator_t* allocator = &ht->arena.allocator;
+    if (capacity > SIZE_MAX / sizeof(slot_t)) {
+        return false;
+    }
+    uint8_t* ctrl = allocator_alloc(allocator, capacity + GROUP_WIDTH);
+    slot_t* slots = allocator_alloc(allocator, capacity * sizeof(slot_t));
+    if (ctrl == NULL || slots == NULL) {
+        allocator_free(allocator, ctrl, capacity + GROUP_WIDTH);
+        allocator_free(allocator, slots, capacity * sizeof(slot_t));
+        return false;
+    }
+    memset(ctrl, CTRL_EMPTY, capacity + GROUP_WIDTH);
+    ht->ctrl = ctrl;
+    ht->slots = slots;
+    ht->size = capacity;
+    ht->growth_left = capacity * SWISS_MAX_LOAD_NUM / SWISS_MAX_LOAD_DEN;
+    return true;
+}
+
+static void swiss_resize(hash_table_t* ht, size_t new_capacity) {
+    uint8_t* old_ctrl = ht->ctrl;
+    slot_t* old_slots = ht->slots;
+    size_t old_capacity = ht->size;
+
+    // If the new arrays cannot be allocated, keep working with the current
+    // ones
+    if (!swiss_alloc(ht, new_capacity)) {
+        return;
+    }
+
+    // Reinsert every entry, dropping tombstones along the way
+    for (size_t i = 0; i < old_capacity; i++) {
+        if (old_ctrl[i] & 0x80) {
+            continue;
+        }
+        uint64_t hash = old_slots[i].hash;
+        size_t index = swiss_find_available(ht, hash);
+        set_ctrl(ht, index, hash_h2(hash));
+        ht->slots[index] = old_slots[i];
+    }
+    ht->growth_left -= ht->count;
+
+    swiss_free_arrays(ht, old_ctrl, old_slots, old_capacity);
+}
+
+bool swiss_init(hash_table_t* ht, size_t size) {
+    size_t capacity = next_power_of_two(size);
+    if (capacity == 0) {
+        return false;
+    }
+    if (capacity < GROUP_WIDTH) {
+        capacity = GROUP_WIDTH;
+    }
+    ht->min_size = capacity;
+    return swiss_alloc(ht, capacity);
+}
+
+void swiss_free(hash_table_t* ht) {
+    // Keys live in the table's arena and are released with it
+    swiss_free_arrays(ht, ht->ctrl, ht->slots, ht->size);
+}
+
+static char* swiss_key_copy(hash_table_t* ht, const char* key, size_t len) {
+    char* copy = arena_alloc(&ht->arena, len + 1);
+    if (copy == NULL) {
+        return NULL;
+    }
+    memcpy(copy, key, len);
+    copy[len] = '\0';
+    return copy;
+}
+
+void** swiss_find_or_insert(hash_table_t* ht, const char* key, size_t len,
+                           uint64_t hash, bool* inserted) {
+    size_t mask = ht->size - 1;
+    size_t pos = hash_h1(hash) & mask;
+    size_t stride = 0;
+    uint8_t h2 = hash_h2(hash);
+    size_t target = ht->size;
+    HT_STAT_ADD(ht, searches, 1);
+
+    // Look for the key, remembering the first slot it could be inserted into
+    while (true) {
+        HT_STAT_ADD(ht, probes, 1);
+        const uint8_t* group = &ht->ctrl[pos];
+        bitmask_t match = group_match(group, h2);
+        while (match != 0) {
+            size_t index = (pos + __builtin_ctz(match)) & mask;
+            slot_t* slot = &ht->slots[index];
+            if (key_matches(slot->hash, slot->key_len, slot->key, hash, len,
+                            key)) {
+                *inserted = false;
+                return &slot->object;
+            }
+            match &= match - 1;
+        }
+        if (target == ht->size) {
+            bitmask_t available = group_match_available(group);
+            if (available != 0) {
+                target = (pos + __builtin_ctz(available)) & mask;
+            }
+        }
+        // An empty slot terminates the probe sequence
+        if (group_match(group, CTRL_EMPTY) != 0) {
+            break;
+        }
+        pos = probe_next(pos, &stride, mask);
+    }
+
+    if (ht->growth_left == 0 && ht->ctrl[target] == CTRL_EMPTY) {
+        // Grow if the table is mostly full, otherwise just clear tombstones
+        size_t threshold = ht->size * SWISS_MAX_LOAD_NUM / SWISS_MAX_LOAD_DEN;
+        size_t new_capacity =
+            ht->count * 2 > threshold ? ht->size * 2 : ht->size;
+        swiss_resize(ht, new_capacity);
+        if (ht->growth_left == 0) {
+            return NULL;
+        }
+        target = swiss_find_available(ht, hash);
+    }
+
+    char* copy = swiss_key_copy(ht, key, len);
+    if (copy == NULL) {
+        return NULL;
+    }
+
+    if (ht->ctrl[target] == CTRL_EMPTY) {
+        ht->growth_left -= 1;
+    }
+    set_ctrl(ht, target, h2);
+    slot_t* slot = &ht->slots[target];
+    slot->hash = hash;
+    slot->key_len = len;
+    slot->key = copy;
+    slot->object = NULL;
+    ht->count += 1;
+    *inserted = true;
+    return &slot->object;
+}
+
+void swiss_stats(hash_table_t* ht, hash_table_stats_t* out) {
+    size_t mask = ht->size - 1;
+    for (size_t i = 0; i < ht->size; i++) {
+        if (ht->ctrl[i] & 0x80) {
+            continue;
+        }
+        // Replay the probe sequence until the group containing the slot
+        size_t pos = hash_h1(ht->slots[i].hash) & mask;
+        size_t stride = 0;
+        size_t groups = 1;
+        while (((i - pos) & mask) >= GROUP_WIDTH) {
+            pos = probe_next(pos, &stride, mask);
+            groups += 1;
+        }
+        histogram_add(out->chain_histogram, groups);
+        if (groups > out->max_chain) {
+            out->max_chain = groups;
+        }
+    }
+    out->bytes_allocated += ht->size + GROUP_WIDTH + ht->size * sizeof(slot_t);
+}
+
+void swiss_visit(hash_table_t* ht, entry_visitor* visit, void* ctx) {
+    for (size_t i = 0; i < ht->size; i++) {
+        if (!(ht->ctrl[i] & 0x80)) {
+            slot_t* slot = &ht->slots[i];
+            visit(ctx, slot->key, slot->key_len, slot->object);
+        }
+    }
+}
+
+void swiss_prefetch(hash_table_t* ht, uint64_t hash) {
+    size_t pos = hash_h1(hash) & (ht->size - 1);
+    __builtin_prefetch(&ht->ctrl[pos]);
+    __builtin_prefetch(&ht->slots[pos]);
+}
+
+void* swiss_lookup(hash_table_t* ht, const char* key, size_t len,
+                   uint64_t hash) {
+    size_t index = swiss_find(ht, key, len, hash);
+    if (index == ht->size) {
+        return NULL;
+    }
+    return ht->slots[index].object;
+}
+
+void* swiss_delete(hash_table_t* ht, const char* key, size_t len,
+                   uint64_t hash) {
+    size_t index = swiss_find(ht, key, len, hash);
+    if (index == ht->size) {
+        return NULL;
+    }
+
+    // The slot can be marked empty again if no probe sequence could have
+    // passed over it, i.e. if every group containing it has an empty slot.
+    size_t mask = ht->size - 1;
+    bitmask_t empty_before =
+        group_match(&ht->ctrl[(index - GROUP_WIDTH) & mask], CTRL_EMPTY);
+    bitmask_t empty_after = group_match(&ht->ctrl[index], CTRL_EMPTY);
+    bool was_never_full =
+        empty_before != 0 && empty_after != 0 &&
+        (size_t)(__builtin_clz(empty_before) - (32 - GROUP_WIDTH) +
+                 __builtin_ctz(empty_after)) < GROUP_WIDTH;
+    if (was_never_full) {
+        set_ctrl(ht, index, CTRL_EMPTY);
+        ht->growth_left += 1;
+    } else {
+        set_ctrl(ht, index, CTRL_DELETED);
+    }
+
+    slot_t* slot = &ht->slots[index];
+    void* obj = slot->object;
+    arena_free(&ht->arena, slot->key, slot->key_len + 1);
+    ht->count -= 1;
+
+    // Give memory back after mass deletions
+    if (ht->size > ht->min_size &&
+        ht->count < ht->size / SWISS_MIN_LOAD_DEN) {
+        size_t new_capacity = next_power_of_two(ht->count * 2);
+        if (new_capacity < ht->min_size) {
+            new_capacity = ht->min_size;
+        }
+        swiss_resize(ht, new_capacity);
+    }
+    return obj;
+}
@@ -0,0 +1,258 @@
+#include "indexedlist.h"
+#include "arena.h"
+#include <stdint.h>
+
+// Maximum height of a node, enough for 4^32 elements
+#define INDEXED_MAX_LEVEL 32
+
+// Link to the next node on one level. `span` is the number of level-0 steps
+// the link skips over; for the last link of a level it counts up to one past
+// the end of the list.
+typedef struct ilink_t {
+    struct inode_t* next;
+    size_t span;
+} ilink_t;
+
+typedef struct inode_t {
+    void* object;
+    size_t level;
+    ilink_t links[];
+} inode_t;
+
+typedef struct _indexed_list {
+    size_t size;
+    size_t level;
+    inode_t* tail;
+    uint64_t random_state;
+    arena_t arena;
+    // Sentinel before the first element, linked on every level
+    inode_t* head;
+} indexed_list_t;
+
+// Draws a node height where each extra level has probability 1/4, which keeps
+// the expected number of links per node at 4/3
+static size_t random_level(indexed_list_t* il) {
+    uint64_t x = il->random_state;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    il->random_state = x;
+    x *= 0x2545f4914f6cdd1dULL;
+    size_t level = 1;
+    while ((x >> 62) == 0 && level < INDEXED_MAX_LEVEL) {
+        level += 1;
+        x <<= 2;
+    }
+    return level;
+}
+
+static size_t inode_size(size_t level) {
+    return sizeof(inode_t) + level * sizeof(ilink_t);
+}
+
+// Finds, on every level, the last node before position `index` and the
+// position of that node, with the head sentinel at position 0
+static void find_predecessors(indexed_list_t* il, size_t index,
+                              inode_t** update, size_t* rank) {
+    inode_t* node = il->head;
+    size_t traversed = 0;
+    // There is always at least one level
+    size_t i = il->level;
+    do {
+        i -= 1;
+        ilink_t* link = &node->links[i];
+        while (link->next != NULL && traversed + link->span <= index) {
+            traversed += link->span;
+            node = link->next;
+            link = &node->links[i];
+        }
+        update[i] = node;
+        rank[i] = traversed;
+    } while (i > 0);
+}
+
+indexed_list_t* indexed_list_create() {
+    indexed_list_t* il = malloc(sizeof(*il));
+    if (il == NULL) {
+        return NULL;
+    }
+    il->head = malloc(inode_size(INDEXED_MAX_LEVEL));
+    if (il->head == NULL) {
+        free(il);
+        return NULL;
+    }
+    il->size = 0;
+    il->level = 1;
+    il->tail = NULL;
+    il->random_state = 0x9e3779b97f4a7c15ULL;
+    arena_init(&il->arena, NULL);
+    il->head->object = NULL;
+    il->head->level = INDEXED_MAX_LEVEL;
+    for (size_t i = 0; i < INDEXED_MAX_LEVEL; i++) {
+        il->head->links[i].next = NULL;
+        il->head->links[i].span = 1;
+    }
+    return il;
+}
+
+void indexed_list_destroy(indexed_list_t* il, void (*free_func)(void*)) {
+    if (il == NULL) {
+        return;
+    }
+    if (free_func != NULL) {
+        inode_t* node = il->head->links[0].next;
+        while (node != NULL) {
+            free_func(node->object);
+            node = node->links[0].next;
+        }
+    }
+    arena_release(&il->arena);
+    free(il->head);
+    free(il);
+}
+
+size_t indexed_list_size(indexed_list_t* il) {
+    if (il == NULL) {
+        return 0;
+    } else {
+        return il->size;
+    }
+}
+
+bool indexed_list_push_front(indexed_list_t* il, void* obj) {
+    return indexed_list_insert(il, 0, obj);
+}
+
+bool indexed_list_push_back(indexed_list_t* il, void* obj) {
+    if (il == NULL) {
+        return false;
+    }
+    return indexed_list_insert(il, il->size, obj);
+}
+
+void* indexed_list_peek_front(indexed_list_t* il) {
+    if (il == NULL || il->head->links[0].next == NULL) {
+        return NULL;
+    }
+    return il->head->links[0].next->object;
+}
+
+void* indexed_list_peek_back(indexed_list_t* il) {
+    if (il == NULL || il->tail == NULL) {
+        return NULL;
+    }
+    return il->tail->object;
+}
+
+void* indexed_list_pop_front(indexed_list_t* il) {
+    return indexed_list_delete(il, 0);
+}
+
+void* indexed_list_pop_back(indexed_list_t* il) {
+    if (il == NULL || il->size == 0) {
+        return NULL;
+    }
+    return indexed_list_delete(il, il->size - 1);
+}
+
+void* indexed_list_lookup(indexed_list_t* il, size_t index) {
+    if (il == NULL || index >= il->size) {
+        return NULL;
+    }
+    if (index == il->size - 1) {
+        return il->tail->object;
+    }
+    inode_t* node = il->head;
+    size_t traversed = 0;
+    for (size_t i = il->level; i > 0; i--) {
+        ilink_t* link = &node->links[i - 1];
+        while (link->next != NULL && traversed + link->span <= index + 1) {
+            traversed += link->span;
+            node = link->next;
+            link = &node->links[i - 1];
+        }
+        if (traversed == index + 1) {
+            break;
+        }
+    }
+    return node->object;
+}
+
+bool indexed_list_insert(indexed_list_t* il, size_t index, void* obj) {
+    if (il == NULL || obj == NULL || index > il->size) {
+        return false;
+    }
+    inode_t* update[INDEXED_MAX_LEVEL];
+    size_t rank[INDEXED_MAX_LEVEL];
+    find_predecessors(il, index, update, rank);
+
+    size_t level = random_level(il);
+    inode_t* node = arena_alloc(&il->arena, inode_size(level));
+    if (node == NULL) {
+        return false;
+    }
+    if (level > il->level) {
+        // New levels start out as a single link from the head to the end
+        for (size_t i = il->level; i < level; i++) {
+            update[i] = il->head;
+            rank[i] = 0;
+            il->head->links[i].next = NULL;
+            il->head->links[i].span = il->size + 1;
+        }
+        il->level = level;
+    }
+
+    node->object = obj;
+    node->level = level;
+    for (size_t i = 0; i < level; i++) {
+        // The new node splits the predecessor's link in two
+        ilink_t* prev = &update[i]->links[i];
+        size_t before = rank[0] - rank[i];
+        node->links[i].next = prev->next;
+        node->links[i].span = prev->span - before;
+        prev->next = node;
+        prev->span = before + 1;
+    }
+    for (size_t i = level; i < il->level; i++) {
+        // Higher links now skip over one more element
+        update[i]->links[i].span += 1;
+    }
+
+    if (node->links[0].next == NULL) {
+        il->tail = node;
+    }
+    il->size += 1;
+    return true;
+}
+
+void* indexed_list_delete(indexed_list_t* il, size_t index) {
+    if (il == NULL || index >= il->size) {
+        return NULL;
+    }
+    inode_t* update[INDEXED_MAX_LEVEL];
+    size_t rank[INDEXED_MAX_LEVEL];
+    find_predecessors(il, index, update, rank);
+
+    inode_t* node = update[0]->links[0].next;
+    for (size_t i = 0; i < il->level; i++) {
+        ilink_t* prev = &update[i]->links[i];
+        if (prev->next == node) {
+            // Merge the node's link into its predecessor's
+            prev->span += node->links[i].span - 1;
+            prev->next = node->links[i].next;
+        } else {
+            prev->span -= 1;
+        }
+    }
+    if (node == il->tail) {
+        il->tail = update[0] == il->head ? NULL : update[0];
+    }
+    while (il->level > 1 && il->head->links[il->level - 1].next == NULL) {
+        il->level -= 1;
+    }
+
+    void* obj = node->object;
+    arena_free(&il->arena, node, inode_size(node->level));
+    il->size -= 1;
+    return obj;
+}
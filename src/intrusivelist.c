@@ -0,0 +1,112 @@
+#include "intrusivelist.h"
+
+// Links `link` between two adjacent links
+static void link_between(intrusive_list_t* list, intrusive_link_t* prev,
+                         intrusive_link_t* next, intrusive_link_t* link) {
+    link->prev = prev;
+    link->next = next;
+    prev->next = link;
+    next->prev = link;
+    list->size += 1;
+}
+
+void intrusive_list_init(intrusive_list_t* list) {
+    list->head.next = &list->head;
+    list->head.prev = &list->head;
+    list->size = 0;
+}
+
+size_t intrusive_list_size(const intrusive_list_t* list) {
+    if (list == NULL) {
+        return 0;
+    } else {
+        return list->size;
+    }
+}
+
+bool intrusive_list_push_front(intrusive_list_t* list, intrusive_link_t* link) {
+    if (list == NULL || link == NULL) {
+        return false;
+    }
+    link_between(list, &list->head, list->head.next, link);
+    return true;
+}
+
+bool intrusive_list_push_back(intrusive_list_t* list, intrusive_link_t* link) {
+    if (list == NULL || link == NULL) {
+        return false;
+    }
+    link_between(list, list->head.prev, &list->head, link);
+    return true;
+}
+
+bool intrusive_list_insert_before(intrusive_list_t* list, intrusive_link_t* pos,
+                                  intrusive_link_t* link) {
+    if (list == NULL || pos == NULL || link == NULL) {
+        return false;
+    }
+    link_between(list, pos->prev, pos, link);
+    return true;
+}
+
+bool intrusive_list_insert_after(intrusive_list_t* list, intrusive_link_t* pos,
+                                 intrusive_link_t* link) {
+    if (list == NULL || pos == NULL || link == NULL) {
+        return false;
+    }
+    link_between(list, pos, pos->next, link);
+    return true;
+}
+
+intrusive_link_t* intrusive_list_front(const intrusive_list_t* list) {
+    if (list == NULL || list->size == 0) {
+        return NULL;
+    }
+    return list->head.next;
+}
+
+intrusive_link_t* intrusive_list_back(const intrusive_list_t* list) {
+    if (list == NULL || list->size == 0) {
+        return NULL;
+    }
+    return list->head.prev;
+}
+
+intrusive_link_t* intrusive_list_next(const intrusive_list_t* list,
+                                      const intrusive_link_t* link) {
+    if (list == NULL || link == NULL || link->next == &list->head) {
+        return NULL;
+    }
+    return link->next;
+}
+
+intrusive_link_t* intrusive_list_prev(const intrusive_list_t* list,
+                                      const intrusive_link_t* link) {
+    if (list == NULL || link == NULL || link->prev == &list->head) {
+        return NULL;
+    }
+    return link->prev;
+}
+
+void intrusive_list_remove(intrusive_list_t* list, intrusive_link_t* link) {
+    if (list == NULL || link == NULL) {
+        return;
+    }
+    link->prev->next = link->next;
+    link->next->prev = link->prev;
+    link->next = NULL;
+    link->prev = NULL;
+    list->size -= 1;
+}
+
+intrusive_link_t* intrusive_list_pop_front(intrusive_list_t* list) {
+    intrusive_link_t* link = intrusive_list_front(list);
+    intrusive_list_remove(list, link);
+    return link;
+}
+
+intrusive_link_t* intrusive_list_pop_back(intrusive_list_t* list) {
+    intrusive_link_t* link = intrusive_list_back(list);
+    intrusive_list_remove(list, link);
+    return link;
+}
@@ -1,24 +1,149 @@
 #include "linkedlist.h"
+#include "arena.h"
+#include <pthread.h>
+
+// Lists shorter than this per thread are not worth sorting in parallel
+#define SORT_MIN_PER_THREAD 16384
+#define SORT_MAX_THREADS 64
 
 typedef struct node_t {
     void* object;
     struct node_t* next;
+    struct node_t* prev;
 } node_t;
 
+typedef struct _linked_list_pool {
+    arena_t arena;
+} linked_list_pool_t;
+
 typedef struct _linked_list {
     size_t size;
     struct node_t* head;
     struct node_t* tail;
+    linked_list_pool_t* pool;
+    // Lists created without a pool own a private one
+    bool owns_pool;
 } linked_list_t;
 
-linked_list_t* linked_list_create() {
-    linked_list_t* ll = malloc(sizeof(*ll));
+static node_t* node_alloc(linked_list_t* ll, void* obj) {
+    node_t* node = arena_alloc(&ll->pool->arena, sizeof(*node));
+    if (node != NULL) {
+        node->object = obj;
+    }
+    return node;
+}
+
+static void node_free(linked_list_t* ll, node_t* node) {
+    arena_free(&ll->pool->arena, node, sizeof(*node));
+}
+
+// Links a new node holding `obj` right before `next`, or at the back of the
+// linked list if `next` is NULL
+static node_t* link_before(linked_list_t* ll, node_t* next, void* obj) {
+    node_t* node = node_alloc(ll, obj);
+    if (node == NULL) {
+        return NULL;
+    }
+    node->next = next;
+    node->prev = next == NULL ? ll->tail : next->prev;
+    if (node->prev != NULL) {
+        node->prev->next = node;
+    } else {
+        ll->head = node;
+    }
+    if (next != NULL) {
+        next->prev = node;
+    } else {
+        ll->tail = node;
+    }
+    ll->size += 1;
+    return node;
+}
+
+// Unlinks `node` from its neighbours, frees it and returns its object
+static void* unlink_node(linked_list_t* ll, node_t* node) {
+    if (node->prev != NULL) {
+        node->prev->next = node->next;
+    } else {
+        ll->head = node->next;
+    }
+    if (node->next != NULL) {
+        node->next->prev = node->prev;
+    } else {
+        ll->tail = node->prev;
+    }
+    void* obj = node->object;
+    node_free(ll, node);
+    ll->size -= 1;
+    return obj;
+}
+
+linked_list_pool_t*
+linked_list_pool_create_with_allocator(const allocator_t* allocator) {
+    // Resolve the default allocator before the pool exists to hold it
+    arena_t arena;
+    arena_init(&arena, allocator);
+    linked_list_pool_t* pool =
+        allocator_alloc(&arena.allocator, sizeof(*pool));
+    if (pool == NULL) {
+        return NULL;
+    }
+    pool->arena = arena;
+    return pool;
+}
+
+linked_list_pool_t* linked_list_pool_create() {
+    return linked_list_pool_create_with_allocator(NULL);
+}
+
+void linked_list_pool_destroy(linked_list_pool_t* pool) {
+    if (pool == NULL) {
+        return;
+    }
+    arena_t arena = pool->arena;
+    allocator_free(&arena.allocator, pool, sizeof(*pool));
+    arena_release(&arena);
+}
+
+// Creates a list on `pool`, or on a private pool drawing from `allocator` if
+// `pool` is NULL. The list structure comes from the pool's allocator.
+static linked_list_t* list_create(linked_list_pool_t* pool,
+                                  const allocator_t* allocator) {
+    bool owns_pool = pool == NULL;
+    if (owns_pool) {
+        pool = linked_list_pool_create_with_allocator(allocator);
+        if (pool == NULL) {
+            return NULL;
+        }
+    }
+    linked_list_t* ll = allocator_alloc(&pool->arena.allocator, sizeof(*ll));
+    if (ll == NULL) {
+        if (owns_pool) {
+            linked_list_pool_destroy(pool);
+        }
+        return NULL;
+    }
+    ll->owns_pool = owns_pool;
     ll->size = 0;
     ll->head = NULL;
     ll->tail = NULL;
+    ll->pool = pool;
     return ll;
 }
 
+linked_list_t* linked_list_create_with_pool(linked_list_pool_t* pool) {
+    return list_create(pool, NULL);
+}
+
+linked_list_t*
+linked_list_create_with_allocator(const allocator_t* allocator) {
+    return list_create(NULL, allocator);
+}
+
+linked_list_t* linked_list_create() {
+    return list_create(NULL, NULL);
+}
+
 void linked_list_destroy(linked_list_t* ll, void (*free_func)(void*)) {
     if (ll == NULL) {
         return;
@@ -29,10 +154,18 @@ void linked_list_destroy(linked_list_t* ll, void (*free_func)(void*)) {
             free_func(current->object);
         }
         node_t* next = current->next;
-        free(current);
+        if (!ll->owns_pool) {
+            node_free(ll, current);
+        }
         current = next;
     }
-    free(ll);
+    linked_list_pool_t* pool = ll->pool;
+    bool owns_pool = ll->owns_pool;
+    allocator_free(&pool->arena.allocator, ll, sizeof(*ll));
+    // A private pool releases all of its chunks at once
+    if (owns_pool) {
+        linked_list_pool_destroy(pool);
+    }
 }
 
 size_t linked_list_size(linked_list_t* ll) {
@@ -49,11 +182,17 @@ bool linked_list_push_front(linked_list_t* ll, void* obj) {
     }
 
     // Create new node
-    node_t* node = malloc(sizeof(*node));
-    node->object = obj;
+    node_t* node = node_alloc(ll, obj);
+    if (node == NULL) {
+        return false;
+    }
     node->next = ll->head;
+    node->prev = NULL;
 
     // Update head and tail
+    if (ll->head != NULL) {
+        ll->head->prev = node;
+    }
     ll->head = node;
     if (ll->tail == NULL) {
         ll->tail = node;
@@ -68,9 +207,12 @@ bool linked_list_push_back(linked_list_t* ll, void* obj) {
     }
 
     // Create new node
-    node_t* node = malloc(sizeof(*node));
-    node->object = obj;
+    node_t* node = node_alloc(ll, obj);
+    if (node == NULL) {
+        return false;
+    }
     node->next = NULL;
+    node->prev = ll->tail;
 
     // Update head and tail
     if (ll->head == NULL) {
@@ -116,11 +258,13 @@ void* linked_list_pop_front(linked_list_t* ll) {
     }
     if (node->next == NULL) {
         ll->head = NULL;
+        ll->tail = NULL;
     } else {
         ll->head = node->next;
+        ll->head->prev = NULL;
     }
     void* obj = node->object;
-    free(node);
+    node_free(ll, node);
     ll->size -= 1;
     return obj;
 }
@@ -134,32 +278,17 @@ void* linked_list_pop_back(linked_list_t* ll) {
         return NULL;
     }
 
-    // Handle case when linked list only has one node
-    if (ll->size == 1) {
+    if (node->prev == NULL) {
         ll->head = NULL;
         ll->tail = NULL;
-        void* obj = node->object;
-        free(node);
-        ll->size -= 1;
-        return obj;
-    }
-
-    // Iterate through linked list to find penultimate node
-    node_t* tmp = ll->head;
-    while (tmp != NULL && tmp->next != node) {
-        tmp = tmp->next;
-    }
-    if (tmp == NULL) {
-        return NULL;
+    } else {
+        ll->tail = node->prev;
+        ll->tail->next = NULL;
     }
 
-    // Set tail to penultimate node
-    ll->tail = tmp;
-    tmp->next = NULL;
-
     // Free popped node and return object
     void* obj = node->object;
-    free(node);
+    node_free(ll, node);
     ll->size -= 1;
     return obj;
 }
@@ -168,15 +297,18 @@ static node_t* lookup_node(linked_list_t* ll, size_t index) {
     if (ll == NULL || index >= ll->size || ll->head == NULL) {
         return NULL;
     }
-    // Iterate through linked list until desired index
-    node_t* node = ll->head;
-    size_t n_iter = 0;
-    while (n_iter < index) {
-        if (node->next == NULL) {
-            return NULL;
+    // Iterate from whichever end of the linked list is closer
+    node_t* node;
+    if (index < ll->size / 2) {
+        node = ll->head;
+        for (size_t i = 0; i < index; i++) {
+            node = node->next;
+        }
+    } else {
+        node = ll->tail;
+        for (size_t i = ll->size - 1; i > index; i--) {
+            node = node->prev;
         }
-        node = node->next;
-        n_iter += 1;
     }
     return node;
 }
@@ -190,45 +322,366 @@ void* linked_list_lookup(linked_list_t* ll, size_t index) {
 }
 
 bool linked_list_insert(linked_list_t* ll, size_t index, void* obj) {
-    if (index == 0) {
-        // If index is beginning of list, push front
-        return linked_list_push_front(ll, obj);
-
-    } else if (index == ll->size) {
-        // If index is end of list, push back
-        return linked_list_push_back(ll, obj);
+    if (ll == NULL || obj == NULL || index > ll->size) {
+        return false;
     }
-    // Look up node before index
-    node_t* node = lookup_node(ll, index - 1);
+    // Link before the node currently at index, or at the back if index is
+    // the size of the list
+    node_t* next = index == ll->size ? NULL : lookup_node(ll, index);
+    return link_before(ll, next, obj) != NULL;
+}
+
+void* linked_list_delete(linked_list_t* ll, size_t index) {
+    node_t* node = lookup_node(ll, index);
     if (node == NULL) {
+        return NULL;
+    }
+    return unlink_node(ll, node);
+}
+
+linked_list_cursor_t linked_list_cursor_front(linked_list_t* ll) {
+    linked_list_cursor_t cursor = {ll, ll == NULL ? NULL : ll->head};
+    return cursor;
+}
+
+linked_list_cursor_t linked_list_cursor_back(linked_list_t* ll) {
+    linked_list_cursor_t cursor = {ll, ll == NULL ? NULL : ll->tail};
+    return cursor;
+}
+
+bool linked_list_cursor_valid(const linked_list_cursor_t* cursor) {
+    return cursor != NULL && cursor->node != NULL;
+}
+
+void* linked_list_cursor_get(const linked_list_cursor_t* cursor) {
+    if (!linked_list_cursor_valid(cursor)) {
+        return NULL;
+    }
+    return ((node_t*)cursor->node)->object;
+}
+
+void linked_list_cursor_next(linked_list_cursor_t* cursor) {
+    if (linked_list_cursor_valid(cursor)) {
+        cursor->node = ((node_t*)cursor->node)->next;
+    }
+}
+
+void linked_list_cursor_prev(linked_list_cursor_t* cursor) {
+    if (cursor == NULL || cursor->list == NULL) {
+        return;
+    }
+    if (cursor->node == NULL) {
+        // Stepping back from past the end lands on the tail
+        cursor->node = cursor->list->tail;
+    } else {
+        cursor->node = ((node_t*)cursor->node)->prev;
+    }
+}
+
+bool linked_list_cursor_insert_before(linked_list_cursor_t* cursor,
+                                      void* obj) {
+    if (cursor == NULL || cursor->list == NULL || obj == NULL) {
         return false;
     }
-    node_t* new_node = malloc(sizeof(*new_node));
-    new_node->object = obj;
-    new_node->next = node->next;
-    node->next = new_node;
-    ll->size += 1;
+    return link_before(cursor->list, cursor->node, obj) != NULL;
+}
+
+bool linked_list_cursor_insert_after(linked_list_cursor_t* cursor, void* obj) {
+    if (!linked_list_cursor_valid(cursor) || obj == NULL) {
+        return false;
+    }
+    node_t* node = cursor->node;
+    return link_before(cursor->list, node->next, obj) != NULL;
+}
+
+void* linked_list_cursor_remove(linked_list_cursor_t* cursor) {
+    if (!linked_list_cursor_valid(cursor)) {
+        return NULL;
+    }
+    node_t* node = cursor->node;
+    cursor->node = node->next;
+    return unlink_node(cursor->list, node);
+}
+
+void linked_list_foreach(linked_list_t* ll, void (*func)(void*, void*),
+                         void* arg) {
+    if (ll == NULL || func == NULL) {
+        return;
+    }
+    for (node_t* node = ll->head; node != NULL; node = node->next) {
+        func(node->object, arg);
+    }
+}
+
+bool linked_list_splice(linked_list_t* dst, linked_list_t* src) {
+    if (dst == NULL || src == NULL || dst == src) {
+        return false;
+    }
+    if (src->head == NULL) {
+        return true;
+    }
+
+    if (src->pool != dst->pool) {
+        if (!src->owns_pool || !allocator_equal(&src->pool->arena.allocator,
+                                                &dst->pool->arena.allocator)) {
+            // Nodes of another shared pool, or of memory from another
+            // allocator, cannot change hands, copy them
+            size_t copied = 0;
+            for (node_t* node = src->head; node != NULL; node = node->next) {
+                if (link_before(dst, NULL, node->object) == NULL) {
+                    // Undo the partial copy
+                    while (copied-- > 0) {
+                        unlink_node(dst, dst->tail);
+                    }
+                    return false;
+                }
+                copied += 1;
+            }
+            while (src->head != NULL) {
+                unlink_node(src, src->head);
+            }
+            return true;
+        }
+        // Hand the private pool's chunks over along with the nodes
+        arena_merge(&dst->pool->arena, &src->pool->arena);
+    }
+
+    // Relink the whole chain after the tail of `dst`
+    src->head->prev = dst->tail;
+    if (dst->tail != NULL) {
+        dst->tail->next = src->head;
+    } else {
+        dst->head = src->head;
+    }
+    dst->tail = src->tail;
+    dst->size += src->size;
+    src->head = NULL;
+    src->tail = NULL;
+    src->size = 0;
     return true;
 }
 
-void* linked_list_delete(linked_list_t* ll, size_t index) {
-    if (index == 0) {
-        // If index is beginning of list, pop front
-        return linked_list_pop_front(ll);
+bool linked_list_push_back_many(linked_list_t* ll, void* const* objs,
+                                size_t n) {
+    if (ll == NULL || (objs == NULL && n > 0)) {
+        return false;
+    }
+    for (size_t i = 0; i < n; i++) {
+        if (objs[i] == NULL) {
+            return false;
+        }
+    }
+
+    // Build the chain on its own first, so that a failed allocation leaves
+    // the list untouched
+    node_t* first = NULL;
+    node_t* last = NULL;
+    for (size_t i = 0; i < n; i++) {
+        node_t* node = node_alloc(ll, objs[i]);
+        if (node == NULL) {
+            while (first != NULL) {
+                node_t* next = first->next;
+                node_free(ll, first);
+                first = next;
+            }
+            return false;
+        }
+        node->prev = last;
+        node->next = NULL;
+        if (last != NULL) {
+            last->next = node;
+        } else {
+            first = node;
+        }
+        last = node;
+    }
+    if (first == NULL) {
+        return true;
+    }
 
-    } else if (index == ll->size) {
-        // If index is end of list, pop back
-        return linked_list_pop_back(ll);
+    first->prev = ll->tail;
+    if (ll->tail != NULL) {
+        ll->tail->next = first;
+    } else {
+        ll->head = first;
     }
-    // Look up node before index
-    node_t* prev = lookup_node(ll, index - 1);
-    if (prev == NULL) {
+    ll->tail = last;
+    ll->size += n;
+    return true;
+}
+
+void** linked_list_to_array(linked_list_t* ll) {
+    if (ll == NULL || ll->size == 0) {
         return NULL;
     }
-    node_t* node = prev->next;
-    prev->next = node->next;
-    void* obj = node->object;
-    free(node);
-    ll->size -= 1;
-    return obj;
+    void** array = malloc(ll->size * sizeof(*array));
+    if (array == NULL) {
+        return NULL;
+    }
+    size_t i = 0;
+    for (node_t* node = ll->head; node != NULL; node = node->next) {
+        array[i++] = node->object;
+    }
+    return array;
+}
+
+// Merges two sorted chains linked through `next` only. Ties are taken from
+// `a` first, which keeps the sort stable.
+static node_t* merge_chains(node_t* a, node_t* b, linked_list_compare* cmp) {
+    node_t head;
+    node_t* tail = &head;
+    while (a != NULL && b != NULL) {
+        if (cmp(b->object, a->object) < 0) {
+            tail->next = b;
+            b = b->next;
+        } else {
+            tail->next = a;
+            a = a->next;
+        }
+        tail = tail->next;
+    }
+    tail->next = a != NULL ? a : b;
+    return head.next;
+}
+
+// Bottom-up merge sort of a chain linked through `next` only. runs[i] holds a
+// sorted run of 2^i nodes, merged like the digits of a binary counter as
+// nodes are added, so no allocation or length pass is needed.
+static node_t* sort_chain(node_t* head, linked_list_compare* cmp) {
+    node_t* runs[64] = {NULL};
+    size_t max_run = 0;
+    while (head != NULL) {
+        node_t* carry = head;
+        head = head->next;
+        carry->next = NULL;
+        size_t i = 0;
+        while (runs[i] != NULL) {
+            // runs[i] holds earlier elements than `carry`
+            carry = merge_chains(runs[i], carry, cmp);
+            runs[i] = NULL;
+            i += 1;
+        }
+        runs[i] = carry;
+        if (i > max_run) {
+            max_run = i;
+        }
+    }
+    node_t* result = NULL;
+    for (size_t i = 0; i <= max_run; i++) {
+        if (runs[i] != NULL) {
+            result = merge_chains(runs[i], result, cmp);
+        }
+    }
+    return result;
+}
+
+// Restores the `prev` pointers, head and tail after the chain was relinked
+static void relink_chain(linked_list_t* ll, node_t* head) {
+    ll->head = head;
+    node_t* prev = NULL;
+    for (node_t* node = head; node != NULL; node = node->next) {
+        node->prev = prev;
+        prev = node;
+    }
+    ll->tail = prev;
+}
+
+void linked_list_sort(linked_list_t* ll, linked_list_compare* cmp) {
+    if (ll == NULL || cmp == NULL || ll->size < 2) {
+        return;
+    }
+    relink_chain(ll, sort_chain(ll->head, cmp));
+}
+
+typedef struct {
+    node_t* a;
+    node_t* b;
+    linked_list_compare* cmp;
+} sort_task_t;
+
+static void* sort_worker(void* ptr) {
+    sort_task_t* task = ptr;
+    task->a = sort_chain(task->a, task->cmp);
+    return NULL;
+}
+
+static void* merge_worker(void* ptr) {
+    sort_task_t* task = ptr;
+    task->a = merge_chains(task->a, task->b, task->cmp);
+    return NULL;
+}
+
+// Runs `func` on every task, on new threads except for the first task,
+// which runs on the calling thread. Tasks whose thread cannot be created
+// also run on the calling thread.
+static void run_tasks(void* (*func)(void*), sort_task_t* tasks, size_t n) {
+    pthread_t threads[SORT_MAX_THREADS];
+    bool started[SORT_MAX_THREADS];
+    for (size_t i = 1; i < n; i++) {
+        started[i] = pthread_create(&threads[i], NULL, func, &tasks[i]) == 0;
+        if (!started[i]) {
+            func(&tasks[i]);
+        }
+    }
+    func(&tasks[0]);
+    for (size_t i = 1; i < n; i++) {
+        if (started[i]) {
+            pthread_join(threads[i], NULL);
+        }
+    }
+}
+
+void linked_list_sort_parallel(linked_list_t* ll, linked_list_compare* cmp,
+                               size_t num_threads) {
+    if (ll == NULL || cmp == NULL || ll->size < 2) {
+        return;
+    }
+    if (num_threads > SORT_MAX_THREADS) {
+        num_threads = SORT_MAX_THREADS;
+    }
+    if (num_threads > ll->size / SORT_MIN_PER_THREAD) {
+        num_threads = ll->size / SORT_MIN_PER_THREAD;
+    }
+    if (num_threads < 2) {
+        linked_list_sort(ll, cmp);
+        return;
+    }
+
+    // Cut the list into one chain per thread and sort them concurrently
+    sort_task_t tasks[SORT_MAX_THREADS];
+    node_t* node = ll->head;
+    for (size_t t = 0; t < num_threads; t++) {
+        size_t length = ll->size / num_threads +
+                        (t < ll->size % num_threads ? 1 : 0);
+        tasks[t].a = node;
+        tasks[t].cmp = cmp;
+        for (size_t i = 1; i < length; i++) {
+            node = node->next;
+        }
+        node_t* next = node->next;
+        node->next = NULL;
+        node = next;
+    }
+    run_tasks(sort_worker, tasks, num_threads);
+
+    // Merge neighbouring runs pairwise, halving the number of runs each round
+    size_t runs = num_threads;
+    while (runs > 1) {
+        sort_task_t merges[SORT_MAX_THREADS];
+        size_t pairs = runs / 2;
+        for (size_t i = 0; i < pairs; i++) {
+            merges[i].a = tasks[2 * i].a;
+            merges[i].b = tasks[2 * i + 1].a;
+            merges[i].cmp = cmp;
+        }
+        run_tasks(merge_worker, merges, pairs);
+        for (size_t i = 0; i < pairs; i++) {
+            tasks[i].a = merges[i].a;
+        }
+        if (runs % 2 == 1) {
+            tasks[pairs].a = tasks[runs - 1].a;
+        }
+        runs = (runs + 1) / 2;
+    }
+    relink_chain(ll, tasks[0].a);
 }
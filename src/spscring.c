@@ -0,0 +1,91 @@
+#include "spscring.h"
+#include <stdatomic.h>
+#include <stdint.h>
+
+#define CACHE_LINE_SIZE 64
+
+// Each side owns one cache line: its own index, which only it writes, and a
+// cached copy of the other side's index, refreshed only when the ring looks
+// full or empty. In the common case neither side touches the other's line.
+typedef struct _spsc_ring {
+    _Alignas(CACHE_LINE_SIZE) _Atomic size_t tail;
+    size_t cached_head;
+    _Alignas(CACHE_LINE_SIZE) _Atomic size_t head;
+    size_t cached_tail;
+    _Alignas(CACHE_LINE_SIZE) size_t mask;
+    void** slots;
+} spsc_ring_t;
+
+spsc_ring_t* spsc_ring_create(size_t capacity) {
+    // Reject capacities whose rounded slot array would not fit in a size_t
+    if (capacity == 0 || capacity > ((SIZE_MAX / sizeof(void*)) >> 1) + 1) {
+        return NULL;
+    }
+    spsc_ring_t* ring = aligned_alloc(CACHE_LINE_SIZE, sizeof(*ring));
+    if (ring == NULL) {
+        return NULL;
+    }
+    size_t size = 1;
+    while (size < capacity) {
+        size <<= 1;
+    }
+    ring->slots = malloc(size * sizeof(void*));
+    if (ring->slots == NULL) {
+        free(ring);
+        return NULL;
+    }
+    ring->mask = size - 1;
+    atomic_init(&ring->head, 0);
+    atomic_init(&ring->tail, 0);
+    ring->cached_head = 0;
+    ring->cached_tail = 0;
+    return ring;
+}
+
+void spsc_ring_destroy(spsc_ring_t* ring, void (*free_func)(void*)) {
+    if (ring == NULL) {
+        return;
+    }
+    if (free_func != NULL) {
+        size_t tail = atomic_load(&ring->tail);
+        for (size_t i = atomic_load(&ring->head); i != tail; i++) {
+            free_func(ring->slots[i & ring->mask]);
+        }
+    }
+    free(ring->slots);
+    free(ring);
+}
+
+bool spsc_ring_push(spsc_ring_t* ring, void* obj) {
+    if (ring == NULL || obj == NULL) {
+        return false;
+    }
+    size_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    if (tail - ring->cached_head > ring->mask) {
+        ring->cached_head =
+            atomic_load_explicit(&ring->head, memory_order_acquire);
+        if (tail - ring->cached_head > ring->mask) {
+            return false;
+        }
+    }
+    ring->slots[tail & ring->mask] = obj;
+    atomic_store_explicit(&ring->tail, tail + 1, memory_order_release);
+    return true;
+}
+
+void* spsc_ring_pop(spsc_ring_t* ring) {
+    if (ring == NULL) {
+        return NULL;
+    }
+    size_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    if (head == ring->cached_tail) {
+        ring->cached_tail =
+            atomic_load_explicit(&ring->tail, memory_order_acquire);
+        if (head == ring->cached_tail) {
+            return NULL;
+        }
+    }
+    void* obj = ring->slots[head & ring->mask];
+    atomic_store_explicit(&ring->head, head + 1, memory_order_release);
+    return obj;
+}
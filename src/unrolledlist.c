@@ -0,0 +1,263 @@
+#include "unrolledlist.h"
+#include "arena.h"
+#include <string.h>
+
+// Number of objects per node, chosen so that a node fills two cache lines
+#define UNROLLED_NODE_SIZE 128
+#define UNROLLED_CAPACITY                                                      \
+    ((UNROLLED_NODE_SIZE - 3 * sizeof(void*)) / sizeof(void*))
+
+typedef struct unode_t {
+    struct unode_t* next;
+    struct unode_t* prev;
+    size_t count;
+    void* objects[UNROLLED_CAPACITY];
+} unode_t;
+
+typedef struct _unrolled_list {
+    size_t size;
+    unode_t* head;
+    unode_t* tail;
+    arena_t arena;
+} unrolled_list_t;
+
+static unode_t* unode_alloc(unrolled_list_t* ul) {
+    unode_t* node = arena_alloc(&ul->arena, sizeof(*node));
+    if (node != NULL) {
+        node->next = NULL;
+        node->prev = NULL;
+        node->count = 0;
+    }
+    return node;
+}
+
+// Links `node` into the list right after `prev`, or at the head if NULL
+static void unode_link_after(unrolled_list_t* ul, unode_t* prev,
+                             unode_t* node) {
+    node->prev = prev;
+    node->next = prev == NULL ? ul->head : prev->next;
+    if (node->next != NULL) {
+        node->next->prev = node;
+    } else {
+        ul->tail = node;
+    }
+    if (prev != NULL) {
+        prev->next = node;
+    } else {
+        ul->head = node;
+    }
+}
+
+static void unode_unlink(unrolled_list_t* ul, unode_t* node) {
+    if (node->prev != NULL) {
+        node->prev->next = node->next;
+    } else {
+        ul->head = node->next;
+    }
+    if (node->next != NULL) {
+        node->next->prev = node->prev;
+    } else {
+        ul->tail = node->prev;
+    }
+    arena_free(&ul->arena, node, sizeof(*node));
+}
+
+// Finds the node holding `index` and the position of the element within it,
+// walking from whichever end of the list is closer
+static unode_t* locate(unrolled_list_t* ul, size_t index, size_t* offset) {
+    unode_t* node;
+    if (index < ul->size / 2) {
+        node = ul->head;
+        while (index >= node->count) {
+            index -= node->count;
+            node = node->next;
+        }
+        *offset = index;
+    } else {
+        size_t from_back = ul->size - 1 - index;
+        node = ul->tail;
+        while (from_back >= node->count) {
+            from_back -= node->count;
+            node = node->prev;
+        }
+        *offset = node->count - 1 - from_back;
+    }
+    return node;
+}
+
+unrolled_list_t* unrolled_list_create() {
+    unrolled_list_t* ul = malloc(sizeof(*ul));
+    if (ul == NULL) {
+        return NULL;
+    }
+    ul->size = 0;
+    ul->head = NULL;
+    ul->tail = NULL;
+    arena_init(&ul->arena, NULL);
+    return ul;
+}
+
+void unrolled_list_destroy(unrolled_list_t* ul, void (*free_func)(void*)) {
+    if (ul == NULL) {
+        return;
+    }
+    if (free_func != NULL) {
+        for (unode_t* node = ul->head; node != NULL; node = node->next) {
+            for (size_t i = 0; i < node->count; i++) {
+                free_func(node->objects[i]);
+            }
+        }
+    }
+    arena_release(&ul->arena);
+    free(ul);
+}
+
+size_t unrolled_list_size(unrolled_list_t* ul) {
+    if (ul == NULL) {
+        return 0;
+    } else {
+        return ul->size;
+    }
+}
+
+bool unrolled_list_push_front(unrolled_list_t* ul, void* obj) {
+    if (ul == NULL || obj == NULL) {
+        return false;
+    }
+    unode_t* node = ul->head;
+    if (node == NULL || node->count == UNROLLED_CAPACITY) {
+        node = unode_alloc(ul);
+        if (node == NULL) {
+            return false;
+        }
+        unode_link_after(ul, NULL, node);
+    }
+    memmove(&node->objects[1], &node->objects[0],
+            node->count * sizeof(void*));
+    node->objects[0] = obj;
+    node->count += 1;
+    ul->size += 1;
+    return true;
+}
+
+bool unrolled_list_push_back(unrolled_list_t* ul, void* obj) {
+    if (ul == NULL || obj == NULL) {
+        return false;
+    }
+    unode_t* node = ul->tail;
+    if (node == NULL || node->count == UNROLLED_CAPACITY) {
+        node = unode_alloc(ul);
+        if (node == NULL) {
+            return false;
+        }
+        unode_link_after(ul, ul->tail, node);
+    }
+    node->objects[node->count++] = obj;
+    ul->size += 1;
+    return true;
+}
+
+void* unrolled_list_peek_front(unrolled_list_t* ul) {
+    if (ul == NULL || ul->head == NULL) {
+        return NULL;
+    }
+    return ul->head->objects[0];
+}
+
+void* unrolled_list_peek_back(unrolled_list_t* ul) {
+    if (ul == NULL || ul->tail == NULL) {
+        return NULL;
+    }
+    return ul->tail->objects[ul->tail->count - 1];
+}
+
+void* unrolled_list_pop_front(unrolled_list_t* ul) {
+    if (ul == NULL || ul->head == NULL) {
+        return NULL;
+    }
+    return unrolled_list_delete(ul, 0);
+}
+
+void* unrolled_list_pop_back(unrolled_list_t* ul) {
+    if (ul == NULL || ul->tail == NULL) {
+        return NULL;
+    }
+    unode_t* node = ul->tail;
+    void* obj = node->objects[--node->count];
+    if (node->count == 0) {
+        unode_unlink(ul, node);
+    }
+    ul->size -= 1;
+    return obj;
+}
+
+void* unrolled_list_lookup(unrolled_list_t* ul, size_t index) {
+    if (ul == NULL || index >= ul->size) {
+        return NULL;
+    }
+    size_t offset;
+    unode_t* node = locate(ul, index, &offset);
+    return node->objects[offset];
+}
+
+bool unrolled_list_insert(unrolled_list_t* ul, size_t index, void* obj) {
+    if (ul == NULL || obj == NULL || index > ul->size) {
+        return false;
+    }
+    if (index == ul->size) {
+        // If index is end of list, push back
+        return unrolled_list_push_back(ul, obj);
+    }
+    size_t offset;
+    unode_t* node = locate(ul, index, &offset);
+
+    if (node->count == UNROLLED_CAPACITY) {
+        // Split the full node, moving its upper half into a new successor
+        unode_t* next = unode_alloc(ul);
+        if (next == NULL) {
+            return false;
+        }
+        size_t half = UNROLLED_CAPACITY / 2;
+        next->count = UNROLLED_CAPACITY - half;
+        memcpy(next->objects, &node->objects[half],
+               next->count * sizeof(void*));
+        node->count = half;
+        unode_link_after(ul, node, next);
+        if (offset > half) {
+            node = next;
+            offset -= half;
+        }
+    }
+    memmove(&node->objects[offset + 1], &node->objects[offset],
+            (node->count - offset) * sizeof(void*));
+    node->objects[offset] = obj;
+    node->count += 1;
+    ul->size += 1;
+    return true;
+}
+
+void* unrolled_list_delete(unrolled_list_t* ul, size_t index) {
+    if (ul == NULL || index >= ul->size) {
+        return NULL;
+    }
+    size_t offset;
+    unode_t* node = locate(ul, index, &offset);
+    void* obj = node->objects[offset];
+    node->count -= 1;
+    memmove(&node->objects[offset], &node->objects[offset + 1],
+            (node->count - offset) * sizeof(void*));
+    ul->size -= 1;
+
+    if (node->count == 0) {
+        unode_unlink(ul, node);
+    } else if (node->count < UNROLLED_CAPACITY / 2 && node->next != NULL &&
+               node->count + node->next->count <= UNROLLED_CAPACITY) {
+        // Merge the successor into this node to keep nodes densely filled
+        unode_t* next = node->next;
+        memcpy(&node->objects[node->count], next->objects,
+               next->count * sizeof(void*));
+        node->count += next->count;
+        unode_unlink(ul, next);
+    }
+    return obj;
+}
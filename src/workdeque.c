@@ -0,0 +1,166 @@
+#include "workdeque.h"
+#include <stdatomic.h>
+#include <stdint.h>
+
+#define CACHE_LINE_SIZE 64
+
+typedef struct buffer_t {
+    size_t mask;
+    // Buffer this one replaced when the deque grew
+    struct buffer_t* previous;
+    _Atomic(void*) slots[];
+} buffer_t;
+
+// Orderings follow "Correct and Efficient Work-Stealing for Weak Memory
+// Models" (Le et al., 2013). `top` and `bottom` only ever increase, except
+// for the owner's tentative decrement of `bottom` in pop.
+typedef struct _work_deque {
+    _Alignas(CACHE_LINE_SIZE) _Atomic int64_t top;
+    _Alignas(CACHE_LINE_SIZE) _Atomic int64_t bottom;
+    _Atomic(buffer_t*) buffer;
+} work_deque_t;
+
+static buffer_t* buffer_create(size_t size) {
+    // A size of 0 comes from doubling the largest power of two
+    if (size == 0 ||
+        size > (SIZE_MAX - sizeof(buffer_t)) / sizeof(_Atomic(void*))) {
+        return NULL;
+    }
+    buffer_t* buffer = malloc(sizeof(*buffer) + size * sizeof(_Atomic(void*)));
+    if (buffer == NULL) {
+        return NULL;
+    }
+    buffer->mask = size - 1;
+    buffer->previous = NULL;
+    return buffer;
+}
+
+// Copies the live objects into a buffer twice as large. Thieves may still be
+// reading the old buffer, so it is only freed with the deque.
+static buffer_t* buffer_grow(work_deque_t* dq, buffer_t* old, int64_t top,
+                             int64_t bottom) {
+    buffer_t* buffer = buffer_create((old->mask + 1) * 2);
+    if (buffer == NULL) {
+        return NULL;
+    }
+    for (int64_t i = top; i < bottom; i++) {
+        void* obj = atomic_load_explicit(&old->slots[i & old->mask],
+                                         memory_order_relaxed);
+        atomic_store_explicit(&buffer->slots[i & buffer->mask], obj,
+                              memory_order_relaxed);
+    }
+    buffer->previous = old;
+    atomic_store_explicit(&dq->buffer, buffer, memory_order_release);
+    return buffer;
+}
+
+work_deque_t* work_deque_create(size_t capacity) {
+    if (capacity > (SIZE_MAX >> 1) + 1) {
+        return NULL;
+    }
+    work_deque_t* dq = aligned_alloc(CACHE_LINE_SIZE, sizeof(*dq));
+    if (dq == NULL) {
+        return NULL;
+    }
+    size_t size = 2;
+    while (size < capacity) {
+        size <<= 1;
+    }
+    buffer_t* buffer = buffer_create(size);
+    if (buffer == NULL) {
+        free(dq);
+        return NULL;
+    }
+    atomic_init(&dq->top, 0);
+    atomic_init(&dq->bottom, 0);
+    atomic_init(&dq->buffer, buffer);
+    return dq;
+}
+
+void work_deque_destroy(work_deque_t* dq) {
+    if (dq == NULL) {
+        return;
+    }
+    buffer_t* buffer = atomic_load(&dq->buffer);
+    while (buffer != NULL) {
+        buffer_t* previous = buffer->previous;
+        free(buffer);
+        buffer = previous;
+    }
+    free(dq);
+}
+
+bool work_deque_push(work_deque_t* dq, void* obj) {
+    if (dq == NULL || obj == NULL) {
+        return false;
+    }
+    int64_t bottom = atomic_load_explicit(&dq->bottom, memory_order_relaxed);
+    int64_t top = atomic_load_explicit(&dq->top, memory_order_acquire);
+    buffer_t* buffer = atomic_load_explicit(&dq->buffer, memory_order_relaxed);
+    if (bottom - top > (int64_t)buffer->mask) {
+        buffer = buffer_grow(dq, buffer, top, bottom);
+        if (buffer == NULL) {
+            return false;
+        }
+    }
+    atomic_store_explicit(&buffer->slots[bottom & buffer->mask], obj,
+                          memory_order_relaxed);
+    // The object must be visible before thieves can see the new bottom
+    atomic_thread_fence(memory_order_release);
+    atomic_store_explicit(&dq->bottom, bottom + 1, memory_order_relaxed);
+    return true;
+}
+
+void* work_deque_pop(work_deque_t* dq) {
+    if (dq == NULL) {
+        return NULL;
+    }
+    int64_t bottom =
+        atomic_load_explicit(&dq->bottom, memory_order_relaxed) - 1;
+    buffer_t* buffer = atomic_load_explicit(&dq->buffer, memory_order_relaxed);
+    atomic_store_explicit(&dq->bottom, bottom, memory_order_relaxed);
+    // Publish the claim on the bottom object before reading top, so that a
+    // concurrent thief either sees it or is seen here
+    atomic_thread_fence(memory_order_seq_cst);
+    int64_t top = atomic_load_explicit(&dq->top, memory_order_relaxed);
+
+    if (top > bottom) {
+        // The deque was empty
+        atomic_store_explicit(&dq->bottom, bottom + 1, memory_order_relaxed);
+        return NULL;
+    }
+    void* obj = atomic_load_explicit(&buffer->slots[bottom & buffer->mask],
+                                     memory_order_relaxed);
+    if (top == bottom) {
+        // Last object: race the thieves for it by advancing top
+        if (!atomic_compare_exchange_strong_explicit(
+                &dq->top, &top, top + 1, memory_order_seq_cst,
+                memory_order_relaxed)) {
+            obj = NULL;
+        }
+        atomic_store_explicit(&dq->bottom, bottom + 1, memory_order_relaxed);
+    }
+    return obj;
+}
+
+void* work_deque_steal(work_deque_t* dq) {
+    if (dq == NULL) {
+        return NULL;
+    }
+    int64_t top = atomic_load_explicit(&dq->top, memory_order_acquire);
+    atomic_thread_fence(memory_order_seq_cst);
+    int64_t bottom = atomic_load_explicit(&dq->bottom, memory_order_acquire);
+    if (top >= bottom) {
+        return NULL;
+    }
+    buffer_t* buffer = atomic_load_explicit(&dq->buffer, memory_order_acquire);
+    void* obj = atomic_load_explicit(&buffer->slots[top & buffer->mask],
+                                     memory_order_relaxed);
+    if (!atomic_compare_exchange_strong_explicit(&dq->top, &top, top + 1,
+                                                 memory_order_seq_cst,
+                                                 memory_order_relaxed)) {
+        // Another thief or the owner took it
+        return NULL;
+    }
+    return obj;
+}
@@ -0,0 +1,171 @@
+#include "concurrenthashtable.h"
+#include <assert.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+
+#define NUM_THREADS 4
+#define KEYS_PER_THREAD 5000
+// More than the usual PTHREAD_KEYS_MAX of 1024
+#define NUM_TABLES 2048
+
+void print_test_passed(const char* test_name) {
+    printf("\t- %s: \033[1;32mPASSED\033[0m\n", test_name);
+}
+
+void test_concurrent_hash_table_create_destroy() {
+    concurrent_hash_table_t* ht = concurrent_hash_table_create(10, NULL);
+    assert(ht != NULL);
+    assert(concurrent_hash_table_size(ht) == 0);
+    concurrent_hash_table_destroy(ht);
+    // Sizes that cannot be rounded up to a power of two are rejected
+    assert(concurrent_hash_table_create(SIZE_MAX, NULL) == NULL);
+    print_test_passed(__func__);
+}
+
+void test_concurrent_hash_table_insert_lookup_delete() {
+    concurrent_hash_table_t* ht = concurrent_hash_table_create(10, NULL);
+    assert(concurrent_hash_table_insert(ht, "key1", (void*)1) == true);
+    assert(concurrent_hash_table_insert(ht, "key2", "value") == true);
+    assert(concurrent_hash_table_insert(ht, "key1", (void*)2) == false);
+    assert(concurrent_hash_table_insert(ht, "key3", NULL) == false);
+    assert(concurrent_hash_table_lookup(ht, "key1") == (void*)1);
+    assert(strcmp(concurrent_hash_table_lookup(ht, "key2"), "value") == 0);
+    assert(concurrent_hash_table_size(ht) == 2);
+    assert(concurrent_hash_table_delete(ht, "key1") == (void*)1);
+    assert(concurrent_hash_table_delete(ht, "key1") == NULL);
+    assert(concurrent_hash_table_lookup(ht, "key1") == NULL);
+    assert(concurrent_hash_table_size(ht) == 1);
+    concurrent_hash_table_destroy(ht);
+    print_test_passed(__func__);
+}
+
+void test_concurrent_hash_table_many_tables() {
+    static concurrent_hash_table_t* tables[NUM_TABLES];
+    // The second round reuses the addresses of the destroyed tables
+    for (size_t round = 0; round < 2; round++) {
+        for (size_t i = 0; i < NUM_TABLES; i++) {
+            tables[i] = concurrent_hash_table_create(0, NULL);
+            assert(tables[i] != NULL);
+            assert(concurrent_hash_table_insert(tables[i], "key",
+                                               (void*)(i + 1)));
+        }
+        for (size_t i = 0; i < NUM_TABLES; i++) {
+            assert(concurrent_hash_table_lookup(tables[i], "key") ==
+                   (void*)(i + 1));
+            concurrent_hash_table_destroy(tables[i]);
+        }
+    }
+    print_test_passed(__func__);
+}
+
+typedef struct {
+    concurrent_hash_table_t* ht;
+    size_t id;
+} worker_args_t;
+
+// Each writer owns a disjoint range of keys: it inserts them all, checks
+// them, then deletes the odd ones. Every thread also reads the other ranges.
+static void* worker(void* ptr) {
+    worker_args_t* args = ptr;
+    char key[32];
+    size_t base = args->id * KEYS_PER_THREAD;
+    for (size_t i = base + 1; i <= base + KEYS_PER_THREAD; i++) {
+        snprintf(key, sizeof(key), "key%zu", i);
+        assert(concurrent_hash_table_insert(args->ht, key, (void*)i));
+        // Concurrent readers only ever see a key's own value
+        snprintf(key, sizeof(key), "key%zu",
+                 (i * 7919) % (NUM_THREADS * KEYS_PER_THREAD) + 1);
+        void* value = concurrent_hash_table_lookup(args->ht, key);
+        assert(value == NULL ||
+               value == (void*)((i * 7919) % (NUM_THREADS * KEYS_PER_THREAD) +
+                                1));
+    }
+    for (size_t i = base + 1; i <= base + KEYS_PER_THREAD; i++) {
+        snprintf(key, sizeof(key), "key%zu", i);
+        assert(concurrent_hash_table_lookup(args->ht, key) == (void*)i);
+        if (i % 2 == 1) {
+            assert(concurrent_hash_table_delete(args->ht, key) == (void*)i);
+        }
+    }
+    return NULL;
+}
+
+void test_concurrent_hash_table_threads() {
+    concurrent_hash_table_t* ht = concurrent_hash_table_create(4, NULL);
+    pthread_t threads[NUM_THREADS];
+    worker_args_t args[NUM_THREADS];
+    for (size_t t = 0; t < NUM_THREADS; t++) {
+        args[t].ht = ht;
+        args[t].id = t;
+        pthread_create(&threads[t], NULL, worker, &args[t]);
+    }
+    for (size_t t = 0; t < NUM_THREADS; t++) {
+        pthread_join(threads[t], NULL);
+    }
+    assert(concurrent_hash_table_size(ht) == NUM_THREADS * KEYS_PER_THREAD / 2);
+    char key[32];
+    for (size_t i = 1; i <= NUM_THREADS * KEYS_PER_THREAD; i++) {
+        snprintf(key, sizeof(key), "key%zu", i);
+        void* expected = i % 2 == 0 ? (void*)i : NULL;
+        assert(concurrent_hash_table_lookup(ht, key) == expected);
+    }
+    concurrent_hash_table_destroy(ht);
+    print_test_passed(__func__);
+}
+
+typedef struct {
+    concurrent_hash_table_t* ht;
+    atomic_bool done;
+} growth_args_t;
+
+// Keys present before the table starts growing must never appear missing
+// while their chains are moved to larger bucket arrays
+static void* stable_reader(void* ptr) {
+    growth_args_t* args = ptr;
+    char key[32];
+    size_t i = 0;
+    while (!atomic_load(&args->done)) {
+        size_t k = i++ % KEYS_PER_THREAD + 1;
+        snprintf(key, sizeof(key), "stable%zu", k);
+        assert(concurrent_hash_table_lookup(args->ht, key) == (void*)k);
+    }
+    return NULL;
+}
+
+void test_concurrent_hash_table_lookup_during_growth() {
+    growth_args_t args;
+    args.ht = concurrent_hash_table_create(0, NULL);
+    atomic_init(&args.done, false);
+    char key[32];
+    for (size_t i = 1; i <= KEYS_PER_THREAD; i++) {
+        snprintf(key, sizeof(key), "stable%zu", i);
+        assert(concurrent_hash_table_insert(args.ht, key, (void*)i));
+    }
+    pthread_t readers[NUM_THREADS];
+    for (size_t t = 0; t < NUM_THREADS; t++) {
+        pthread_create(&readers[t], NULL, stable_reader, &args);
+    }
+    for (size_t i = 1; i <= NUM_THREADS * KEYS_PER_THREAD; i++) {
+        snprintf(key, sizeof(key), "grow%zu", i);
+        assert(concurrent_hash_table_insert(args.ht, key, (void*)i));
+    }
+    atomic_store(&args.done, true);
+    for (size_t t = 0; t < NUM_THREADS; t++) {
+        pthread_join(readers[t], NULL);
+    }
+    assert(concurrent_hash_table_size(args.ht) ==
+           (NUM_THREADS + 1) * KEYS_PER_THREAD);
+    concurrent_hash_table_destroy(args.ht);
+    print_test_passed(__func__);
+}
+
+int main(int argc, char** argv) {
+    printf("Running tests in: %s\n", argv[0]);
+    test_concurrent_hash_table_create_destroy();
+    test_concurrent_hash_table_insert_lookup_delete();
+    test_concurrent_hash_table_many_tables();
+    test_concurrent_hash_table_threads();
+    test_concurrent_hash_table_lookup_during_growth();
+    return 0;
+}
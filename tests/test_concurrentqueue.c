@@ -0,0 +1,124 @@
+#include "concurrentqueue.h"
+#include <assert.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+
+#define NUM_PRODUCERS 4
+#define NUM_CONSUMERS 4
+#define ITEMS_PER_PRODUCER 20000
+
+void print_test_passed(const char* test_name) {
+    printf("\t- %s: \033[1;32mPASSED\033[0m\n", test_name);
+}
+
+void test_concurrent_queue_create_destroy() {
+    concurrent_queue_t* q = concurrent_queue_create();
+    assert(q != NULL);
+    assert(concurrent_queue_pop_front(q) == NULL);
+    concurrent_queue_destroy(q, NULL);
+    print_test_passed(__func__);
+}
+
+void test_concurrent_queue_push_pop() {
+    concurrent_queue_t* q = concurrent_queue_create();
+    assert(concurrent_queue_push_back(q, NULL) == false);
+    // Objects come out in the order they went in
+    for (size_t i = 1; i <= 100; i++) {
+        assert(concurrent_queue_push_back(q, (void*)i) == true);
+    }
+    for (size_t i = 1; i <= 100; i++) {
+        assert(concurrent_queue_pop_front(q) == (void*)i);
+    }
+    assert(concurrent_queue_pop_front(q) == NULL);
+    // The emptied queue is reusable
+    assert(concurrent_queue_push_back(q, (int*)1) == true);
+    assert(concurrent_queue_pop_front(q) == (int*)1);
+    concurrent_queue_destroy(q, NULL);
+    print_test_passed(__func__);
+}
+
+void test_concurrent_queue_destroy_free_func() {
+    concurrent_queue_t* q = concurrent_queue_create();
+    for (size_t i = 0; i < 10; i++) {
+        concurrent_queue_push_back(q, malloc(16));
+    }
+    free(concurrent_queue_pop_front(q));
+    // Destroying with free() must not leak nor double free
+    concurrent_queue_destroy(q, free);
+    print_test_passed(__func__);
+}
+
+typedef struct {
+    concurrent_queue_t* q;
+    size_t id;
+    _Atomic size_t* consumed;
+    unsigned char* seen;
+} worker_args_t;
+
+// Objects encode their producer and a per-producer sequence number
+static void* producer(void* ptr) {
+    worker_args_t* args = ptr;
+    for (size_t i = 0; i < ITEMS_PER_PRODUCER; i++) {
+        size_t item = args->id * ITEMS_PER_PRODUCER + i + 1;
+        assert(concurrent_queue_push_back(args->q, (void*)item));
+    }
+    return NULL;
+}
+
+// Every object must be seen exactly once, and objects of one producer must
+// come out in the order they were pushed
+static void* consumer(void* ptr) {
+    worker_args_t* args = ptr;
+    size_t last[NUM_PRODUCERS] = {0};
+    while (*args->consumed < NUM_PRODUCERS * ITEMS_PER_PRODUCER) {
+        size_t item = (size_t)concurrent_queue_pop_front(args->q);
+        if (item == 0) {
+            sched_yield();
+            continue;
+        }
+        size_t from = (item - 1) / ITEMS_PER_PRODUCER;
+        assert(item > last[from]);
+        last[from] = item;
+        assert(args->seen[item - 1] == 0);
+        args->seen[item - 1] = 1;
+        (*args->consumed)++;
+    }
+    return NULL;
+}
+
+void test_concurrent_queue_threads() {
+    concurrent_queue_t* q = concurrent_queue_create();
+    _Atomic size_t consumed = 0;
+    unsigned char* seen = calloc(NUM_PRODUCERS * ITEMS_PER_PRODUCER, 1);
+    pthread_t threads[NUM_PRODUCERS + NUM_CONSUMERS];
+    worker_args_t args[NUM_PRODUCERS + NUM_CONSUMERS];
+    for (size_t t = 0; t < NUM_PRODUCERS + NUM_CONSUMERS; t++) {
+        args[t].q = q;
+        args[t].id = t;
+        args[t].consumed = &consumed;
+        args[t].seen = seen;
+        pthread_create(&threads[t], NULL,
+                       t < NUM_PRODUCERS ? producer : consumer, &args[t]);
+    }
+    for (size_t t = 0; t < NUM_PRODUCERS + NUM_CONSUMERS; t++) {
+        pthread_join(threads[t], NULL);
+    }
+    assert(consumed == NUM_PRODUCERS * ITEMS_PER_PRODUCER);
+    for (size_t i = 0; i < NUM_PRODUCERS * ITEMS_PER_PRODUCER; i++) {
+        assert(seen[i] == 1);
+    }
+    assert(concurrent_queue_pop_front(q) == NULL);
+    free(seen);
+    concurrent_queue_destroy(q, NULL);
+    print_test_passed(__func__);
+}
+
+int main(int argc, char** argv) {
+    printf("Running tests in: %s\n", argv[0]);
+    test_concurrent_queue_create_destroy();
+    test_concurrent_queue_push_pop();
+    test_concurrent_queue_destroy_free_func();
+    test_concurrent_queue_threads();
+    return 0;
+}
@@ -0,0 +1,57 @@
+#include "hashfunctions.h"
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+
+void print_test_passed(const char* test_name) {
+    printf("\t- %s: \033[1;32mPASSED\033[0m\n", test_name);
+}
+
+void test_hash_wyhash_deterministic() {
+    // Same key and seed give the same hash for every length class
+    char key[128];
+    for (size_t i = 0; i < sizeof(key); i++) {
+        key[i] = (char)(i * 7 + 1);
+    }
+    for (size_t len = 0; len <= sizeof(key); len++) {
+        assert(hash_wyhash(key, len, 42) == hash_wyhash(key, len, 42));
+    }
+    // The hash only depends on the key bytes, not on their address
+    char copy[128];
+    memcpy(copy, key + 3, 100);
+    assert(hash_wyhash(key + 3, 100, 1) == hash_wyhash(copy, 100, 1));
+    print_test_passed(__func__);
+}
+
+void test_hash_wyhash_sensitivity() {
+    char key[128];
+    memset(key, 'a', sizeof(key));
+    for (size_t len = 1; len <= sizeof(key); len++) {
+        uint64_t hash = hash_wyhash(key, len, 0);
+        // Different seeds select different functions
+        assert(hash != hash_wyhash(key, len, 1));
+        // Flipping any byte changes the hash
+        for (size_t i = 0; i < len; i++) {
+            key[i] ^= 1;
+            assert(hash != hash_wyhash(key, len, 0));
+            key[i] ^= 1;
+        }
+        // So does the length, even with NUL padding
+        assert(hash_wyhash("\0\0\0\0", len % 4, 0) !=
+               hash_wyhash("\0\0\0\0", len % 4 + 1, 0));
+    }
+    print_test_passed(__func__);
+}
+
+void test_hash_random_seed() {
+    assert(hash_random_seed() != hash_random_seed());
+    print_test_passed(__func__);
+}
+
+int main(int argc, char** argv) {
+    printf("Running tests in: %s\n", argv[0]);
+    test_hash_wyhash_deterministic();
+    test_hash_wyhash_sensitivity();
+    test_hash_random_seed();
+    return 0;
+}
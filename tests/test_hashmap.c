@@ -0,0 +1,206 @@
+#include "hashmap.h"
+#include <assert.h>
+#include <stdio.h>
+
+typedef struct {
+    uint32_t x;
+    uint32_t y;
+    uint64_t z;
+} point_t;
+
+static uint64_t string_hash(const char* key, uint64_t seed) {
+    return hash_wyhash(key, strlen(key), seed);
+}
+
+static bool string_equal(const char* a, const char* b) {
+    return strcmp(a, b) == 0;
+}
+
+DEFINE_HASH_MAP(u64_map, uint64_t, uint64_t)
+DEFINE_HASH_MAP(u32_map, uint32_t, double)
+DEFINE_HASH_MAP(point_map, point_t, int)
+DEFINE_HASH_MAP_CUSTOM(str_map, const char*, int, string_hash, string_equal)
+
+void print_test_passed(const char* test_name) {
+    printf("\t- %s: \033[1;32mPASSED\033[0m\n", test_name);
+}
+
+void test_hash_map_create_destroy() {
+    u64_map_t* map = u64_map_create(0);
+    assert(map != NULL);
+    assert(u64_map_size(map) == 0);
+    assert(u64_map_lookup(map, 1) == NULL);
+    assert(u64_map_delete(map, 1, NULL) == false);
+    u64_map_destroy(map);
+    // NULL maps are rejected
+    assert(u64_map_size(NULL) == 0);
+    assert(u64_map_insert(NULL, 1, 1) == false);
+    assert(u64_map_lookup(NULL, 1) == NULL);
+    u64_map_destroy(NULL);
+    // Sizes whose slot array cannot be represented are rejected
+    assert(u64_map_create(SIZE_MAX) == NULL);
+    assert(u64_map_create(SIZE_MAX / 4) == NULL);
+    print_test_passed(__func__);
+}
+
+void test_hash_map_insert_lookup() {
+    u64_map_t* map = u64_map_create(4);
+    // Key 0 is an ordinary key
+    for (uint64_t i = 0; i < 1000; i++) {
+        assert(u64_map_insert(map, i * 7919, i + 100) == true);
+    }
+    assert(u64_map_size(map) == 1000);
+    for (uint64_t i = 0; i < 1000; i++) {
+        uint64_t* value = u64_map_lookup(map, i * 7919);
+        assert(value != NULL && *value == i + 100);
+    }
+    assert(u64_map_lookup(map, 1) == NULL);
+    // Existing keys are not overwritten
+    assert(u64_map_insert(map, 7919, 5) == false);
+    assert(*u64_map_lookup(map, 7919) == 101);
+    // Values are stored inline and can be updated through the pointer
+    *u64_map_lookup(map, 7919) = 5;
+    assert(*u64_map_lookup(map, 7919) == 5);
+    u64_map_destroy(map);
+    print_test_passed(__func__);
+}
+
+void test_hash_map_emplace() {
+    u32_map_t* map = u32_map_create(0);
+    const uint32_t keys[] = {3, 1, 3, 3, 2, 1};
+    for (size_t i = 0; i < 6; i++) {
+        bool inserted;
+        double* count = u32_map_emplace(map, keys[i], &inserted);
+        assert(count != NULL);
+        // New values start zeroed
+        assert(inserted == (*count == 0.0));
+        *count += 1.0;
+    }
+    assert(u32_map_size(map) == 3);
+    assert(*u32_map_lookup(map, 1) == 2.0);
+    assert(*u32_map_lookup(map, 2) == 1.0);
+    assert(*u32_map_lookup(map, 3) == 3.0);
+    u32_map_destroy(map);
+    print_test_passed(__func__);
+}
+
+// Random inserts and deletes checked against a plain array, exercising the
+// backward shift of deletions, growth and shrinking
+void test_hash_map_delete() {
+    enum { KEYS = 4096 };
+    static uint64_t expected[KEYS];
+    u64_map_t* map = u64_map_create(0);
+    size_t count = 0;
+    uint64_t state = 88172645463325252ULL;
+    for (size_t op = 0; op < 200000; op++) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        uint64_t key = state % KEYS;
+        if (expected[key] == 0) {
+            assert(u64_map_insert(map, key, op + 1) == true);
+            expected[key] = op + 1;
+            count++;
+        } else {
+            uint64_t value;
+            assert(u64_map_delete(map, key, &value) == true);
+            assert(value == expected[key]);
+            expected[key] = 0;
+            count--;
+        }
+        assert(u64_map_size(map) == count);
+    }
+    for (uint64_t key = 0; key < KEYS; key++) {
+        uint64_t* value = u64_map_lookup(map, key);
+        assert(expected[key] == 0 ? value == NULL : *value == expected[key]);
+    }
+    // Delete everything, letting the table shrink
+    for (uint64_t key = 0; key < KEYS; key++) {
+        assert(u64_map_delete(map, key, NULL) == (expected[key] != 0));
+    }
+    assert(u64_map_size(map) == 0);
+    assert(map->capacity == map->min_capacity);
+    u64_map_destroy(map);
+    print_test_passed(__func__);
+}
+
+void test_hash_map_struct_keys() {
+    point_map_t* map = point_map_create(0);
+    // point_t has no padding, so its bytes can be hashed and compared
+    for (uint32_t i = 0; i < 100; i++) {
+        point_t p = {i, i * 2, (uint64_t)i << 40};
+        assert(point_map_insert(map, p, (int)i) == true);
+    }
+    for (uint32_t i = 0; i < 100; i++) {
+        point_t p = {i, i * 2, (uint64_t)i << 40};
+        assert(*point_map_lookup(map, p) == (int)i);
+        p.z += 1;
+        assert(point_map_lookup(map, p) == NULL);
+    }
+    point_map_destroy(map);
+    print_test_passed(__func__);
+}
+
+void test_hash_map_custom() {
+    str_map_t* map = str_map_create(0);
+    char buffer[16];
+    assert(str_map_insert(map, "alpha", 1) == true);
+    assert(str_map_insert(map, "beta", 2) == true);
+    // Keys are compared by content, not by address
+    strcpy(buffer, "alpha");
+    assert(*str_map_lookup(map, buffer) == 1);
+    assert(str_map_insert(map, buffer, 3) == false);
+    assert(str_map_delete(map, "beta", NULL) == true);
+    assert(str_map_lookup(map, "beta") == NULL);
+    str_map_destroy(map);
+    print_test_passed(__func__);
+}
+
+// Allocator that keeps track of the memory it has handed out
+typedef struct {
+    size_t live_blocks;
+    size_t live_bytes;
+} counting_t;
+
+static void* counting_alloc(void* context, size_t size) {
+    counting_t* counts = context;
+    counts->live_blocks += 1;
+    counts->live_bytes += size;
+    return malloc(size);
+}
+
+static void counting_free(void* context, void* ptr, size_t size) {
+    counting_t* counts = context;
+    counts->live_blocks -= 1;
+    counts->live_bytes -= size;
+    free(ptr);
+}
+
+void test_hash_map_allocator() {
+    counting_t counts = {0, 0};
+    allocator_t allocator = {counting_alloc, counting_free, &counts};
+    u64_map_t* map = u64_map_create_with_allocator(0, &allocator);
+    assert(counts.live_blocks == 3);
+    for (uint64_t i = 0; i < 10000; i++) {
+        u64_map_insert(map, i, i);
+    }
+    for (uint64_t i = 0; i < 10000; i++) {
+        u64_map_delete(map, i, NULL);
+    }
+    assert(counts.live_blocks == 3);
+    u64_map_destroy(map);
+    assert(counts.live_blocks == 0 && counts.live_bytes == 0);
+    print_test_passed(__func__);
+}
+
+int main(int argc, char** argv) {
+    printf("Running tests in: %s\n", argv[0]);
+    test_hash_map_create_destroy();
+    test_hash_map_insert_lookup();
+    test_hash_map_emplace();
+    test_hash_map_delete();
+    test_hash_map_struct_keys();
+    test_hash_map_custom();
+    test_hash_map_allocator();
+    return 0;
+}
@@ -1,6 +1,10 @@
+#include "hashfunctions.h"
 #include "hashtable.h"
 #include <assert.h>
+#include <pthread.h>
 #include <stdio.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 uint64_t simple_hash(const char* key) {
     uint64_t hash = 0;
@@ -10,14 +14,70 @@ uint64_t simple_hash(const char* key) {
     return hash;
 }
 
+uint64_t constant_hash(const char* key) {
+    (void)key;
+    return 42;
+}
+
+uint64_t simple_hash_n(const void* key, size_t len) {
+    const unsigned char* bytes = key;
+    uint64_t hash = 0;
+    for (size_t i = 0; i < len; i++) {
+        hash = (hash << 5) + hash + bytes[i];
+    }
+    return hash;
+}
+
 void print_test_passed(const char* test_name) {
     printf("\t- %s: \033[1;32mPASSED\033[0m\n", test_name);
 }
 
+// Allocator that keeps track of the memory it has handed out
+typedef struct {
+    size_t allocs;
+    size_t live_blocks;
+    size_t live_bytes;
+} counting_t;
+
+static void* counting_alloc(void* context, size_t size) {
+    counting_t* counts = context;
+    counts->allocs += 1;
+    counts->live_blocks += 1;
+    counts->live_bytes += size;
+    return malloc(size);
+}
+
+static void counting_free(void* context, void* ptr, size_t size) {
+    counting_t* counts = context;
+    counts->live_blocks -= 1;
+    counts->live_bytes -= size;
+    free(ptr);
+}
+
+// Allocator that refuses every request once its budget is spent
+static void* limited_alloc(void* context, size_t size) {
+    size_t* budget = context;
+    if (*budget == 0) {
+        return NULL;
+    }
+    *budget -= 1;
+    return malloc(size);
+}
+
+static void limited_free(void* context, void* ptr, size_t size) {
+    (void)context;
+    (void)size;
+    free(ptr);
+}
+
 void test_hash_table_create_destroy() {
     hash_table_t* ht = hash_table_create(10, simple_hash);
     assert(ht != NULL);
     hash_table_destroy(ht);
+    // Sizes that cannot be rounded up to a power of two are rejected
+    assert(hash_table_create(SIZE_MAX, NULL) == NULL);
+    assert(hash_table_create_with_engine(SIZE_MAX, NULL,
+                                         HASH_TABLE_OPEN_ADDRESSING) == NULL);
     print_test_passed(__func__);
 }
 
@@ -42,10 +102,598 @@ void test_hash_table_delete() {
     print_test_passed(__func__);
 }
 
+static void check_grow_shrink(hash_table_engine_t engine) {
+    hash_table_t* ht = hash_table_create_with_engine(4, simple_hash, engine);
+    char key[32];
+    // Insert many more keys than buckets
+    for (size_t i = 1; i <= 10000; i++) {
+        snprintf(key, sizeof(key), "key%zu", i);
+        assert(hash_table_insert(ht, key, (void*)i) == true);
+    }
+    assert(hash_table_size(ht) == 10000);
+    for (size_t i = 1; i <= 10000; i++) {
+        snprintf(key, sizeof(key), "key%zu", i);
+        assert(hash_table_lookup(ht, key) == (void*)i);
+    }
+    // Duplicates are still rejected while entries are being migrated
+    assert(hash_table_insert(ht, "key1", (void*)1) == false);
+    hash_table_stats_t stats;
+    assert(hash_table_stats(ht, &stats) == true);
+    size_t grown_buckets = stats.buckets;
+    assert(grown_buckets >= 8192);
+    // Delete most keys so that the table shrinks
+    for (size_t i = 1; i <= 9990; i++) {
+        snprintf(key, sizeof(key), "key%zu", i);
+        assert(hash_table_delete(ht, key) == (void*)i);
+    }
+    assert(hash_table_size(ht) == 10);
+    assert(hash_table_stats(ht, &stats) == true);
+    // Chained tables shrink again only once the previous migration is done,
+    // so allow for one pending step
+    assert(stats.buckets <= grown_buckets / 4);
+    for (size_t i = 1; i <= 10000; i++) {
+        snprintf(key, sizeof(key), "key%zu", i);
+        void* expected = i > 9990 ? (void*)i : NULL;
+        assert(hash_table_lookup(ht, key) == expected);
+    }
+    hash_table_destroy(ht);
+}
+
+void test_hash_table_grow_shrink() {
+    check_grow_shrink(HASH_TABLE_CHAINING);
+    print_test_passed(__func__);
+}
+
+void test_hash_table_open_addressing() {
+    hash_table_t* ht = hash_table_create_with_engine(
+        10, simple_hash, HASH_TABLE_OPEN_ADDRESSING);
+    assert(hash_table_insert(ht, "key1", (void*)1) == true);
+    assert(hash_table_insert(ht, "key2", "value") == true);
+    assert(hash_table_insert(ht, "key1", (void*)2) == false);
+    assert(hash_table_lookup(ht, "key1") == (void*)1);
+    assert(strcmp(hash_table_lookup(ht, "key2"), "value") == 0);
+    assert(hash_table_delete(ht, "key1") == (void*)1);
+    assert(hash_table_lookup(ht, "key1") == NULL);
+    assert(hash_table_delete(ht, "key1") == NULL);
+    hash_table_destroy(ht);
+    // Growth, tombstone reuse and shrinking
+    check_grow_shrink(HASH_TABLE_OPEN_ADDRESSING);
+    print_test_passed(__func__);
+}
+
+void test_hash_table_collisions() {
+    hash_table_engine_t engines[] = {HASH_TABLE_CHAINING,
+                                     HASH_TABLE_OPEN_ADDRESSING};
+    for (size_t i = 0; i < 2; i++) {
+        // Every key has the same hash, so only the key bytes tell them apart
+        hash_table_t* ht =
+            hash_table_create_with_engine(8, constant_hash, engines[i]);
+        assert(hash_table_insert(ht, "key", (void*)1) == true);
+        assert(hash_table_insert(ht, "key_longer", (void*)2) == true);
+        assert(hash_table_insert(ht, "kez", (void*)3) == true);
+        assert(hash_table_insert(ht, "kez", (void*)4) == false);
+        assert(hash_table_lookup(ht, "key") == (void*)1);
+        assert(hash_table_lookup(ht, "key_longer") == (void*)2);
+        assert(hash_table_lookup(ht, "kez") == (void*)3);
+        assert(hash_table_lookup(ht, "ke") == NULL);
+        assert(hash_table_delete(ht, "key") == (void*)1);
+        assert(hash_table_lookup(ht, "key_longer") == (void*)2);
+        hash_table_destroy(ht);
+    }
+    print_test_passed(__func__);
+}
+
+void test_hash_table_binary_keys() {
+    hash_table_engine_t engines[] = {HASH_TABLE_CHAINING,
+                                     HASH_TABLE_OPEN_ADDRESSING};
+    for (size_t i = 0; i < 2; i++) {
+        hash_table_t* ht = hash_table_create_n(8, simple_hash_n, engines[i]);
+        // Keys containing NUL bytes are distinct from their prefixes
+        assert(hash_table_insert_n(ht, "a\0b", 3, (void*)1) == true);
+        assert(hash_table_insert_n(ht, "a\0c", 3, (void*)2) == true);
+        assert(hash_table_insert(ht, "a", (void*)3) == true);
+        assert(hash_table_lookup_n(ht, "a\0b", 3) == (void*)1);
+        assert(hash_table_lookup_n(ht, "a\0c", 3) == (void*)2);
+        assert(hash_table_lookup(ht, "a") == (void*)3);
+        // Keys can be sliced out of a larger buffer
+        const char* buffer = "GET /index.html HTTP/1.1";
+        assert(hash_table_insert_n(ht, buffer + 4, 11, (void*)4) == true);
+        assert(hash_table_lookup(ht, "/index.html") == (void*)4);
+        assert(hash_table_lookup_n(ht, buffer + 4, 10) == NULL);
+        assert(hash_table_delete_n(ht, "a\0b", 3) == (void*)1);
+        assert(hash_table_lookup_n(ht, "a\0b", 3) == NULL);
+        hash_table_destroy(ht);
+    }
+    // String hash functions work with sliced keys too
+    hash_table_t* ht = hash_table_create(8, simple_hash);
+    assert(hash_table_insert(ht, "key", (void*)1) == true);
+    assert(hash_table_lookup_n(ht, "keys", 3) == (void*)1);
+    assert(hash_table_delete_n(ht, "keys", 3) == (void*)1);
+    hash_table_destroy(ht);
+    print_test_passed(__func__);
+}
+
+void test_hash_table_upsert() {
+    hash_table_engine_t engines[] = {HASH_TABLE_CHAINING,
+                                     HASH_TABLE_OPEN_ADDRESSING};
+    for (size_t i = 0; i < 2; i++) {
+        hash_table_t* ht = hash_table_create_with_engine(8, simple_hash,
+                                                         engines[i]);
+        // Get or insert keeps the first object
+        assert(hash_table_get_or_insert(ht, "key", (void*)1) == (void*)1);
+        assert(hash_table_get_or_insert(ht, "key", (void*)2) == (void*)1);
+        assert(hash_table_size(ht) == 1);
+        // Upsert replaces and returns the previous object
+        assert(hash_table_upsert(ht, "key", (void*)3) == (void*)1);
+        assert(hash_table_upsert(ht, "other", (void*)4) == NULL);
+        assert(hash_table_lookup(ht, "key") == (void*)3);
+        assert(hash_table_lookup(ht, "other") == (void*)4);
+        assert(hash_table_upsert_n(ht, "other!", 5, (void*)5) == (void*)4);
+        assert(hash_table_get_or_insert_n(ht, "k\0", 2, (void*)6) == (void*)6);
+        hash_table_destroy(ht);
+    }
+    print_test_passed(__func__);
+}
+
+void test_hash_table_emplace() {
+    hash_table_engine_t engines[] = {HASH_TABLE_CHAINING,
+                                     HASH_TABLE_OPEN_ADDRESSING};
+    for (size_t i = 0; i < 2; i++) {
+        hash_table_t* ht = hash_table_create_with_engine(4, simple_hash,
+                                                         engines[i]);
+        // Count word occurrences in place
+        const char* words[] = {"a", "b", "a", "c", "a", "b"};
+        for (size_t j = 0; j < 6; j++) {
+            bool inserted;
+            void** slot = hash_table_emplace(ht, words[j], &inserted);
+            assert(slot != NULL);
+            assert(inserted == (*slot == NULL));
+            *slot = (void*)((uintptr_t)*slot + 1);
+        }
+        assert(hash_table_size(ht) == 3);
+        assert(hash_table_lookup(ht, "a") == (void*)3);
+        assert(hash_table_lookup(ht, "b") == (void*)2);
+        assert(hash_table_lookup(ht, "c") == (void*)1);
+        bool inserted;
+        void** slot = hash_table_emplace_n(ht, "abc", 1, &inserted);
+        assert(inserted == false && *slot == (void*)3);
+        hash_table_destroy(ht);
+    }
+    print_test_passed(__func__);
+}
+
+void test_hash_table_lookup_batch() {
+    hash_table_engine_t engines[] = {HASH_TABLE_CHAINING,
+                                     HASH_TABLE_OPEN_ADDRESSING};
+    for (size_t i = 0; i < 2; i++) {
+        hash_table_t* ht = hash_table_create_with_engine(4, simple_hash,
+                                                         engines[i]);
+        char names[100][16];
+        const char* keys[100];
+        for (size_t j = 0; j < 100; j++) {
+            snprintf(names[j], sizeof(names[j]), "key%zu", j);
+            keys[j] = names[j];
+            // Only even keys are present
+            if (j % 2 == 0) {
+                hash_table_insert(ht, keys[j], (void*)(j + 1));
+            }
+        }
+        keys[99] = NULL;
+        void* out[100];
+        hash_table_lookup_batch(ht, keys, 100, out);
+        for (size_t j = 0; j < 99; j++) {
+            assert(out[j] == (j % 2 == 0 ? (void*)(j + 1) : NULL));
+        }
+        assert(out[99] == NULL);
+        size_t lens[2] = {4, 3};
+        const void* binary_keys[2] = {"key2", "key2"};
+        hash_table_lookup_batch_n(ht, binary_keys, lens, 2, out);
+        assert(out[0] == (void*)3 && out[1] == NULL);
+        hash_table_destroy(ht);
+    }
+    print_test_passed(__func__);
+}
+
+void test_hash_table_default_hash() {
+    hash_table_engine_t engines[] = {HASH_TABLE_CHAINING,
+                                     HASH_TABLE_OPEN_ADDRESSING};
+    for (size_t i = 0; i < 2; i++) {
+        // A NULL hash function selects the bundled seeded hash
+        hash_table_t* ht = hash_table_create_with_engine(8, NULL, engines[i]);
+        char key[32];
+        for (size_t j = 1; j <= 1000; j++) {
+            snprintf(key, sizeof(key), "key%zu", j);
+            assert(hash_table_insert(ht, key, (void*)j) == true);
+        }
+        assert(hash_table_insert_n(ht, "a\0b", 3, (void*)1) == true);
+        for (size_t j = 1; j <= 1000; j++) {
+            snprintf(key, sizeof(key), "key%zu", j);
+            assert(hash_table_lookup(ht, key) == (void*)j);
+        }
+        assert(hash_table_lookup_n(ht, "a\0b", 3) == (void*)1);
+        assert(hash_table_lookup(ht, "a") == NULL);
+        hash_table_destroy(ht);
+    }
+    print_test_passed(__func__);
+}
+
+void test_hash_table_stats() {
+    hash_table_engine_t engines[] = {HASH_TABLE_CHAINING,
+                                     HASH_TABLE_OPEN_ADDRESSING};
+    for (size_t i = 0; i < 2; i++) {
+        hash_table_t* ht = hash_table_create_with_engine(16, NULL, engines[i]);
+        hash_table_stats_t stats;
+        assert(hash_table_stats(ht, NULL) == false);
+        assert(hash_table_stats(ht, &stats) == true);
+        assert(stats.count == 0 && stats.max_chain == 0);
+        char key[32];
+        for (size_t j = 1; j <= 100; j++) {
+            snprintf(key, sizeof(key), "key%zu", j);
+            hash_table_insert(ht, key, (void*)j);
+        }
+        for (size_t j = 1; j <= 200; j++) {
+            snprintf(key, sizeof(key), "key%zu", j);
+            hash_table_lookup(ht, key);
+        }
+        assert(hash_table_stats(ht, &stats) == true);
+        assert(stats.count == 100);
+        assert(stats.buckets >= 100);
+        assert(stats.load_factor == 100.0 / stats.buckets);
+        assert(stats.max_chain >= 1);
+        assert(stats.bytes_allocated > stats.buckets);
+        // Every entry is accounted for in the histogram
+        size_t total = 0;
+        for (size_t j = 0; j < HASH_TABLE_HISTOGRAM_SIZE; j++) {
+            total += engines[i] == HASH_TABLE_CHAINING
+                         ? j * stats.chain_histogram[j]
+                         : stats.chain_histogram[j];
+        }
+        assert(total == 100);
+        if (stats.counters_enabled) {
+            assert(stats.lookups == 200);
+            assert(stats.hits == 100 && stats.misses == 100);
+            assert(stats.avg_probes > 0.0);
+        } else {
+            assert(stats.lookups == 0 && stats.avg_probes == 0.0);
+        }
+        hash_table_destroy(ht);
+    }
+    print_test_passed(__func__);
+}
+
+void test_hash_table_allocator() {
+    hash_table_engine_t engines[] = {HASH_TABLE_CHAINING,
+                                     HASH_TABLE_OPEN_ADDRESSING};
+    for (size_t i = 0; i < 2; i++) {
+        counting_t counts = {0, 0, 0};
+        allocator_t allocator = {counting_alloc, counting_free, &counts};
+        hash_table_t* ht =
+            hash_table_create_with_allocator(8, NULL, engines[i], &allocator);
+        assert(ht != NULL);
+        assert(counts.live_blocks > 0);
+        // Grow and shrink the table. Every 100th key is long enough to need
+        // an arena chunk of its own.
+        char key[8192];
+        for (size_t j = 0; j < 4000; j++) {
+            size_t pad = j % 100 == 0 ? 5000 : 0;
+            memset(key, 'k', pad);
+            snprintf(key + pad, 32, "%zu", j % 2000);
+            if (j < 2000) {
+                assert(hash_table_insert(ht, key, (void*)(j + 1)) == true);
+            } else {
+                assert(hash_table_delete(ht, key) == (void*)(j - 1999));
+            }
+        }
+        size_t allocs = counts.allocs;
+        hash_table_destroy(ht);
+        // Every block came from the allocator and went back to it
+        assert(allocs > 2);
+        assert(counts.live_blocks == 0 && counts.live_bytes == 0);
+    }
+    print_test_passed(__func__);
+}
+
+void test_hash_table_failing_allocator() {
+    hash_table_engine_t engines[] = {HASH_TABLE_CHAINING,
+                                     HASH_TABLE_OPEN_ADDRESSING};
+    for (size_t i = 0; i < 2; i++) {
+        // Creation fails whether the table or its arrays are refused
+        for (size_t budget = 0; budget < 2; budget++) {
+            size_t left = budget;
+            allocator_t allocator = {limited_alloc, limited_free, &left};
+            assert(hash_table_create_with_allocator(8, NULL, engines[i],
+                                                    &allocator) == NULL);
+        }
+
+        // Long keys hashed by a string hash function need a copy, which
+        // fails once the allocator refuses
+        size_t left = 16;
+        allocator_t allocator = {limited_alloc, limited_free, &left};
+        hash_table_t* ht = hash_table_create_with_allocator(
+            8, simple_hash, engines[i], &allocator);
+        assert(ht != NULL);
+        assert(hash_table_insert(ht, "key", (void*)1) == true);
+        left = 0;
+        size_t len = 100000;
+        char* key = malloc(len);
+        memset(key, 'k', len);
+        bool inserted;
+        assert(hash_table_lookup_n(ht, key, len) == NULL);
+        assert(hash_table_insert_n(ht, key, len, (void*)1) == false);
+        assert(hash_table_delete_n(ht, key, len) == NULL);
+        assert(hash_table_upsert_n(ht, key, len, (void*)1) == NULL);
+        assert(hash_table_get_or_insert_n(ht, key, len, (void*)1) == NULL);
+        assert(hash_table_emplace_n(ht, key, len, &inserted) == NULL);
+        const void* keys[] = {key, "key"};
+        size_t lens[] = {len, 3};
+        void* out[2];
+        hash_table_lookup_batch_n(ht, keys, lens, 2, out);
+        assert(out[0] == NULL && out[1] == (void*)1);
+        assert(hash_table_size(ht) == 1);
+        free(key);
+        hash_table_destroy(ht);
+    }
+    print_test_passed(__func__);
+}
+
+void test_hash_table_freeze() {
+    hash_table_engine_t engines[] = {HASH_TABLE_CHAINING,
+                                     HASH_TABLE_OPEN_ADDRESSING};
+    for (size_t i = 0; i < 2; i++) {
+        counting_t counts = {0, 0, 0};
+        allocator_t allocator = {counting_alloc, counting_free, &counts};
+        hash_table_t* ht =
+            hash_table_create_with_allocator(8, NULL, engines[i], &allocator);
+
+        // An empty table freezes into an empty snapshot
+        frozen_hash_table_t* ft = hash_table_freeze(ht);
+        assert(ft != NULL);
+        assert(frozen_hash_table_size(ft) == 0);
+        assert(frozen_hash_table_lookup(ft, "key") == NULL);
+        frozen_hash_table_destroy(ft);
+
+        // Freeze while the chained table is still migrating entries, after
+        // growing past 4096 buckets
+        char key[32];
+        for (size_t j = 0; j < 5000; j++) {
+            snprintf(key, sizeof(key), "key%zu", j);
+            assert(hash_table_insert(ht, key, (void*)(j + 1)) == true);
+        }
+        for (size_t j = 0; j < 5000; j += 5) {
+            snprintf(key, sizeof(key), "key%zu", j);
+            assert(hash_table_delete(ht, key) == (void*)(j + 1));
+        }
+        const char binary[] = {'k', '\0', 'e', '\0', 'y'};
+        assert(hash_table_insert_n(ht, binary, sizeof(binary), (void*)1) ==
+               true);
+        assert(hash_table_insert_n(ht, "", 0, (void*)2) == true);
+
+        ft = hash_table_freeze(ht);
+        assert(ft != NULL);
+        assert(frozen_hash_table_size(ft) == hash_table_size(ht));
+        assert(frozen_hash_table_size(ft) == 4002);
+        assert(frozen_hash_table_bytes(ft) > 4002 * 16);
+        // The snapshot does not depend on the source table
+        hash_table_destroy(ht);
+        for (size_t j = 0; j < 6000; j++) {
+            snprintf(key, sizeof(key), "key%zu", j);
+            void* expected = j < 5000 && j % 5 != 0 ? (void*)(j + 1) : NULL;
+            assert(frozen_hash_table_lookup(ft, key) == expected);
+        }
+        assert(frozen_hash_table_lookup_n(ft, binary, sizeof(binary)) ==
+               (void*)1);
+        assert(frozen_hash_table_lookup_n(ft, binary, 1) == NULL);
+        assert(frozen_hash_table_lookup(ft, "") == (void*)2);
+        assert(frozen_hash_table_lookup(ft, NULL) == NULL);
+        frozen_hash_table_destroy(ft);
+        assert(counts.live_blocks == 0 && counts.live_bytes == 0);
+    }
+    assert(hash_table_freeze(NULL) == NULL);
+    assert(frozen_hash_table_size(NULL) == 0);
+    assert(frozen_hash_table_lookup(NULL, "key") == NULL);
+    print_test_passed(__func__);
+}
+
+static const void* serialize_string(const void* object, size_t* size) {
+    *size = strlen(object) + 1;
+    return object;
+}
+
+static const void* serialize_fail(const void* object, size_t* size) {
+    (void)object;
+    (void)size;
+    return NULL;
+}
+
+// Overwrites one byte of a file
+static void patch_file(const char* path, long offset, char byte) {
+    FILE* f = fopen(path, "r+b");
+    assert(f != NULL);
+    fseek(f, offset, SEEK_SET);
+    fputc(byte, f);
+    fclose(f);
+}
+
+// Overwrites 8 bytes of a snapshot file and recomputes its checksum, as a
+// faulty writer would. Returns the bytes that were there.
+static uint64_t patch_snapshot(const char* path, long offset, uint64_t bytes) {
+    // The checksum hashes the 72-byte header, with the checksum at offset 24
+    // zeroed, then seeds a hash of the rest of the file
+    const size_t header_size = 72;
+    FILE* f = fopen(path, "r+b");
+    assert(f != NULL);
+    fseek(f, 0, SEEK_END);
+    size_t size = ftell(f);
+    char* file = malloc(size);
+    rewind(f);
+    assert(fread(file, 1, size, f) == size);
+    uint64_t old;
+    memcpy(&old, file + offset, sizeof(old));
+    memcpy(file + offset, &bytes, sizeof(bytes));
+    memset(file + 24, 0, sizeof(uint64_t));
+    uint64_t checksum =
+        hash_wyhash(file + header_size, size - header_size,
+                    hash_wyhash(file, header_size, 0x6a09e667f3bcc908ULL));
+    memcpy(file + 24, &checksum, sizeof(checksum));
+    rewind(f);
+    assert(fwrite(file, 1, size, f) == size);
+    fclose(f);
+    free(file);
+    return old;
+}
+
+typedef struct {
+    const char* path;
+    const char* value;
+} save_args_t;
+
+static void* save_repeatedly(void* ptr) {
+    save_args_t* args = ptr;
+    hash_table_t* ht = hash_table_create(8, NULL);
+    char key[16];
+    for (size_t i = 0; i < 100; i++) {
+        snprintf(key, sizeof(key), "key%zu", i);
+        hash_table_insert(ht, key, (void*)args->value);
+    }
+    for (size_t i = 0; i < 20; i++) {
+        assert(hash_table_save(ht, args->path, serialize_string) == true);
+    }
+    hash_table_destroy(ht);
+    return NULL;
+}
+
+void test_hash_table_save_open_mmap() {
+    char path[] = "/tmp/test_hashtable_XXXXXX";
+    int fd = mkstemp(path);
+    assert(fd >= 0);
+    close(fd);
+
+    hash_table_t* ht = hash_table_create(8, NULL);
+    char(*values)[32] = malloc(3000 * sizeof(*values));
+    char key[32];
+    for (size_t i = 0; i < 3000; i++) {
+        snprintf(key, sizeof(key), "key%zu", i);
+        snprintf(values[i], sizeof(values[i]), "value-%zu", i * i);
+        assert(hash_table_insert(ht, key, values[i]) == true);
+    }
+    const char binary[] = {'k', '\0', 'e', '\0', 'y'};
+    assert(hash_table_insert_n(ht, binary, sizeof(binary), "bin") == true);
+    assert(hash_table_save(ht, path, serialize_fail) == false);
+    assert(hash_table_save(ht, path, serialize_string) == true);
+    hash_table_destroy(ht);
+    free(values);
+
+    // The file is created with the permissions the umask allows
+    mode_t mask = umask(0);
+    umask(mask);
+    struct stat st;
+    assert(stat(path, &st) == 0 && (st.st_mode & 0777) == (0666 & ~mask));
+
+    // Lookups are served from the file alone
+    frozen_hash_table_t* ft = hash_table_open_mmap(path);
+    assert(ft != NULL);
+    assert(frozen_hash_table_size(ft) == 3001);
+    char expected[32];
+    size_t size;
+    for (size_t i = 0; i < 4000; i++) {
+        snprintf(key, sizeof(key), "key%zu", i);
+        const char* value = frozen_hash_table_lookup(ft, key);
+        if (i < 3000) {
+            snprintf(expected, sizeof(expected), "value-%zu", i * i);
+            assert(value != NULL && strcmp(value, expected) == 0);
+            assert((uintptr_t)value % 8 == 0);
+            assert(frozen_hash_table_lookup_value(ft, key, strlen(key),
+                                                  &size) == value);
+            assert(size == strlen(expected) + 1);
+        } else {
+            assert(value == NULL);
+        }
+    }
+    assert(strcmp(frozen_hash_table_lookup_n(ft, binary, sizeof(binary)),
+                  "bin") == 0);
+    frozen_hash_table_destroy(ft);
+
+    // Empty tables round-trip too
+    ht = hash_table_create(8, NULL);
+    assert(hash_table_save(ht, path, serialize_string) == true);
+    hash_table_destroy(ht);
+    ft = hash_table_open_mmap(path);
+    assert(ft != NULL && frozen_hash_table_size(ft) == 0);
+    assert(frozen_hash_table_lookup(ft, "key0") == NULL);
+    frozen_hash_table_destroy(ft);
+
+    // Concurrent saves to the same path leave one complete file
+    save_args_t args[2] = {{path, "first"}, {path, "second"}};
+    pthread_t threads[2];
+    for (size_t i = 0; i < 2; i++) {
+        pthread_create(&threads[i], NULL, save_repeatedly, &args[i]);
+    }
+    for (size_t i = 0; i < 2; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    ft = hash_table_open_mmap(path);
+    assert(ft != NULL && frozen_hash_table_size(ft) == 100);
+    const char* winner = frozen_hash_table_lookup(ft, "key0");
+    for (size_t i = 0; i < 100; i++) {
+        snprintf(key, sizeof(key), "key%zu", i);
+        assert(strcmp(frozen_hash_table_lookup(ft, key), winner) == 0);
+    }
+    frozen_hash_table_destroy(ft);
+
+    // Corrupted, stale and truncated files are rejected
+    ht = hash_table_create(8, NULL);
+    assert(hash_table_insert(ht, "key", "value") == true);
+    assert(hash_table_save(ht, path, serialize_string) == true);
+    hash_table_destroy(ht);
+    FILE* f = fopen(path, "rb");
+    fseek(f, 0, SEEK_END);
+    long file_size = ftell(f);
+    fclose(f);
+    patch_file(path, file_size - 1, 'x');
+    assert(hash_table_open_mmap(path) == NULL);
+    patch_file(path, file_size - 1, '\0');
+    assert((ft = hash_table_open_mmap(path)) != NULL);
+    frozen_hash_table_destroy(ft);
+    patch_file(path, 8, 99);
+    assert(hash_table_open_mmap(path) == NULL);
+    patch_file(path, 8, 1);
+    // So are files with a valid checksum that point outside themselves: the
+    // displacement, the remapped position and the key offset of the slot
+    long fields[] = {72, 80, 88};
+    for (size_t i = 0; i < 3; i++) {
+        uint64_t old = patch_snapshot(path, fields[i], 1ULL << 40 | 1u << 30);
+        assert(hash_table_open_mmap(path) == NULL);
+        patch_snapshot(path, fields[i], old);
+        assert((ft = hash_table_open_mmap(path)) != NULL);
+        assert(strcmp(frozen_hash_table_lookup(ft, "key"), "value") == 0);
+        frozen_hash_table_destroy(ft);
+    }
+    assert(truncate(path, file_size - 8) == 0);
+    assert(hash_table_open_mmap(path) == NULL);
+    assert(truncate(path, 0) == 0);
+    assert(hash_table_open_mmap(path) == NULL);
+    unlink(path);
+    assert(hash_table_open_mmap(path) == NULL);
+    print_test_passed(__func__);
+}
+
 int main(int argc, char** argv) {
     printf("Running tests in: %s\n", argv[0]);
     test_hash_table_create_destroy();
     test_hash_table_insert_lookup();
     test_hash_table_delete();
+    test_hash_table_grow_shrink();
+    test_hash_table_open_addressing();
+    test_hash_table_collisions();
+    test_hash_table_binary_keys();
+    test_hash_table_upsert();
+    test_hash_table_emplace();
+    test_hash_table_lookup_batch();
+    test_hash_table_default_hash();
+    test_hash_table_stats();
+    test_hash_table_allocator();
+    test_hash_table_failing_allocator();
+    test_hash_table_freeze();
+    test_hash_table_save_open_mmap();
     return 0;
 }
@@ -0,0 +1,143 @@
+#include "indexedlist.h"
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+
+void print_test_passed(const char* test_name) {
+    printf("\t- %s: \033[1;32mPASSED\033[0m\n", test_name);
+}
+
+void test_indexed_list_create_destroy() {
+    // Create list
+    indexed_list_t* il = indexed_list_create();
+    assert(il != NULL);
+    assert(indexed_list_size(il) == 0);
+    // Destroy list
+    indexed_list_destroy(il, NULL);
+    // Report
+    print_test_passed(__func__);
+}
+
+void test_indexed_list_push_pop() {
+    // Create list
+    indexed_list_t* il = indexed_list_create();
+    // Empty list
+    assert(indexed_list_peek_front(il) == NULL);
+    assert(indexed_list_peek_back(il) == NULL);
+    assert(indexed_list_pop_front(il) == NULL);
+    assert(indexed_list_pop_back(il) == NULL);
+    // Try pushing NULL
+    assert(indexed_list_push_front(il, NULL) == false);
+    assert(indexed_list_push_back(il, NULL) == false);
+    // Push enough elements on both ends to build several levels
+    for (size_t i = 1; i <= 100; i++) {
+        assert(indexed_list_push_back(il, (void*)(100 + i)) == true);
+        assert(indexed_list_push_front(il, (void*)(101 - i)) == true);
+    }
+    assert(indexed_list_size(il) == 200);
+    assert(indexed_list_peek_front(il) == (void*)1);
+    assert(indexed_list_peek_back(il) == (void*)200);
+    // Pop from both ends
+    for (size_t i = 1; i <= 100; i++) {
+        assert(indexed_list_pop_front(il) == (void*)i);
+        assert(indexed_list_pop_back(il) == (void*)(201 - i));
+    }
+    assert(indexed_list_size(il) == 0);
+    assert(indexed_list_peek_front(il) == NULL);
+    assert(indexed_list_peek_back(il) == NULL);
+    // The emptied list is reusable
+    assert(indexed_list_push_back(il, "value") == true);
+    assert(strcmp(indexed_list_peek_front(il), "value") == 0);
+    // Destroy list and report
+    indexed_list_destroy(il, NULL);
+    print_test_passed(__func__);
+}
+
+void test_indexed_list_insert_delete() {
+    // Create list
+    indexed_list_t* il = indexed_list_create();
+    // Insert invalid
+    assert(indexed_list_insert(il, 1, (int*)1) == false);
+    assert(indexed_list_delete(il, 0) == NULL);
+    // Insert at the front, back and within
+    assert(indexed_list_insert(il, 0, (int*)2) == true);
+    assert(indexed_list_insert(il, 0, (int*)1) == true);
+    assert(indexed_list_insert(il, 2, (int*)4) == true);
+    assert(indexed_list_insert(il, 2, (int*)3) == true);
+    for (size_t i = 0; i < 4; i++) {
+        assert(indexed_list_lookup(il, i) == (void*)(i + 1));
+    }
+    assert(indexed_list_lookup(il, 4) == NULL);
+    // Delete invalid
+    assert(indexed_list_delete(il, 4) == NULL);
+    assert(indexed_list_size(il) == 4);
+    // Delete from within, the front and the back
+    assert(indexed_list_delete(il, 1) == (int*)2);
+    assert(indexed_list_delete(il, 0) == (int*)1);
+    assert(indexed_list_delete(il, 1) == (int*)4);
+    assert(indexed_list_size(il) == 1);
+    assert(indexed_list_peek_front(il) == (int*)3);
+    assert(indexed_list_peek_back(il) == (int*)3);
+    // Destroy list and report
+    indexed_list_destroy(il, NULL);
+    print_test_passed(__func__);
+}
+
+void test_indexed_list_random() {
+    // Apply random inserts and deletes to the list and to a plain array, so
+    // that span bookkeeping is checked against a reference
+    enum { MAX_ELEMENTS = 2000, NUM_OPS = 20000 };
+    indexed_list_t* il = indexed_list_create();
+    void** ref = malloc(MAX_ELEMENTS * sizeof(*ref));
+    size_t size = 0;
+    unsigned int seed = 1;
+    for (size_t op = 0; op < NUM_OPS; op++) {
+        seed = seed * 1103515245 + 12345;
+        size_t r = seed >> 8;
+        if (size < MAX_ELEMENTS && (size == 0 || r % 3 != 0)) {
+            size_t index = r % (size + 1);
+            void* obj = (void*)(op + 1);
+            assert(indexed_list_insert(il, index, obj) == true);
+            memmove(&ref[index + 1], &ref[index],
+                    (size - index) * sizeof(*ref));
+            ref[index] = obj;
+            size++;
+        } else {
+            size_t index = r % size;
+            assert(indexed_list_delete(il, index) == ref[index]);
+            memmove(&ref[index], &ref[index + 1],
+                    (size - index - 1) * sizeof(*ref));
+            size--;
+        }
+        assert(indexed_list_size(il) == size);
+        assert(indexed_list_peek_back(il) == (size ? ref[size - 1] : NULL));
+    }
+    for (size_t i = 0; i < size; i++) {
+        assert(indexed_list_lookup(il, i) == ref[i]);
+    }
+    // Destroy list and report
+    free(ref);
+    indexed_list_destroy(il, NULL);
+    print_test_passed(__func__);
+}
+
+void test_indexed_list_destroy_free_func() {
+    // Create list of heap-allocated objects
+    indexed_list_t* il = indexed_list_create();
+    for (size_t i = 0; i < 50; i++) {
+        indexed_list_push_back(il, malloc(16));
+    }
+    // Destroying with free() must not leak
+    indexed_list_destroy(il, free);
+    print_test_passed(__func__);
+}
+
+int main(int argc, char** argv) {
+    printf("Running tests in: %s\n", argv[0]);
+    test_indexed_list_create_destroy();
+    test_indexed_list_push_pop();
+    test_indexed_list_insert_delete();
+    test_indexed_list_random();
+    test_indexed_list_destroy_free_func();
+    return 0;
+}
@@ -0,0 +1,114 @@
+#include "intrusivelist.h"
+#include <assert.h>
+#include <stdio.h>
+
+typedef struct {
+    size_t value;
+    intrusive_link_t link;
+} item_t;
+
+void print_test_passed(const char* test_name) {
+    printf("\t- %s: \033[1;32mPASSED\033[0m\n", test_name);
+}
+
+static void init_items(item_t* items, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        items[i].value = i + 1;
+    }
+}
+
+static size_t value_of(intrusive_link_t* link) {
+    return intrusive_list_entry(link, item_t, link)->value;
+}
+
+void test_intrusive_list_init() {
+    intrusive_list_t list;
+    intrusive_list_init(&list);
+    assert(intrusive_list_size(&list) == 0);
+    assert(intrusive_list_front(&list) == NULL);
+    assert(intrusive_list_back(&list) == NULL);
+    assert(intrusive_list_pop_front(&list) == NULL);
+    assert(intrusive_list_pop_back(&list) == NULL);
+    print_test_passed(__func__);
+}
+
+void test_intrusive_list_push_pop() {
+    intrusive_list_t list;
+    intrusive_list_init(&list);
+    item_t items[4];
+    init_items(items, 4);
+    assert(intrusive_list_push_back(&list, NULL) == false);
+    // Build 1 2 3 4 from both ends
+    assert(intrusive_list_push_back(&list, &items[2].link) == true);
+    assert(intrusive_list_push_back(&list, &items[3].link) == true);
+    assert(intrusive_list_push_front(&list, &items[1].link) == true);
+    assert(intrusive_list_push_front(&list, &items[0].link) == true);
+    assert(intrusive_list_size(&list) == 4);
+    assert(value_of(intrusive_list_front(&list)) == 1);
+    assert(value_of(intrusive_list_back(&list)) == 4);
+    // The entry macro recovers the containing object
+    assert(intrusive_list_entry(intrusive_list_front(&list), item_t, link) ==
+           &items[0]);
+    // Pop from both ends
+    assert(intrusive_list_pop_front(&list) == &items[0].link);
+    assert(intrusive_list_pop_back(&list) == &items[3].link);
+    assert(intrusive_list_pop_back(&list) == &items[2].link);
+    assert(intrusive_list_pop_front(&list) == &items[1].link);
+    assert(intrusive_list_size(&list) == 0);
+    assert(intrusive_list_front(&list) == NULL);
+    // Popped links can be pushed again
+    assert(intrusive_list_push_back(&list, &items[0].link) == true);
+    assert(intrusive_list_back(&list) == &items[0].link);
+    print_test_passed(__func__);
+}
+
+void test_intrusive_list_insert_remove() {
+    intrusive_list_t list;
+    intrusive_list_init(&list);
+    item_t items[5];
+    init_items(items, 5);
+    intrusive_list_push_back(&list, &items[2].link);
+    // Insert around an element
+    assert(intrusive_list_insert_before(&list, &items[2].link,
+                                        &items[0].link) == true);
+    assert(intrusive_list_insert_after(&list, &items[0].link,
+                                       &items[1].link) == true);
+    assert(intrusive_list_insert_after(&list, &items[2].link,
+                                       &items[4].link) == true);
+    assert(intrusive_list_insert_before(&list, &items[4].link,
+                                        &items[3].link) == true);
+    // Walk forwards and backwards
+    size_t expected = 1;
+    intrusive_list_foreach(pos, &list) {
+        assert(value_of(pos) == expected++);
+    }
+    assert(expected == 6);
+    intrusive_link_t* link = intrusive_list_back(&list);
+    for (size_t i = 5; i >= 1; i--) {
+        assert(value_of(link) == i);
+        link = intrusive_list_prev(&list, link);
+    }
+    assert(link == NULL);
+    assert(intrusive_list_next(&list, &items[4].link) == NULL);
+    // Remove odd elements while walking
+    link = intrusive_list_front(&list);
+    while (link != NULL) {
+        intrusive_link_t* next = intrusive_list_next(&list, link);
+        if (value_of(link) % 2 == 1) {
+            intrusive_list_remove(&list, link);
+        }
+        link = next;
+    }
+    assert(intrusive_list_size(&list) == 2);
+    assert(value_of(intrusive_list_front(&list)) == 2);
+    assert(value_of(intrusive_list_back(&list)) == 4);
+    print_test_passed(__func__);
+}
+
+int main(int argc, char** argv) {
+    printf("Running tests in: %s\n", argv[0]);
+    test_intrusive_list_init();
+    test_intrusive_list_push_pop();
+    test_intrusive_list_insert_remove();
+    return 0;
+}
@@ -7,6 +7,26 @@ void print_test_passed(const char* test_name) {
     printf("\t- %s: \033[1;32mPASSED\033[0m\n", test_name);
 }
 
+// Allocator that keeps track of the memory it has handed out
+typedef struct {
+    size_t live_blocks;
+    size_t live_bytes;
+} counting_t;
+
+static void* counting_alloc(void* context, size_t size) {
+    counting_t* counts = context;
+    counts->live_blocks += 1;
+    counts->live_bytes += size;
+    return malloc(size);
+}
+
+static void counting_free(void* context, void* ptr, size_t size) {
+    counting_t* counts = context;
+    counts->live_blocks -= 1;
+    counts->live_bytes -= size;
+    free(ptr);
+}
+
 void test_linked_list_create_destroy() {
     // Create linked list
     linked_list_t* ll = linked_list_create();
@@ -174,6 +194,8 @@ void test_linked_list_insert() {
     assert(linked_list_lookup(ll, 1) == (int*)2);
     // Insert invalid
     assert(linked_list_insert(ll, 10, (int*)10) == false);
+    assert(linked_list_insert(ll, 1, NULL) == false);
+    assert(linked_list_insert(NULL, 1, (int*)10) == false);
     assert(linked_list_size(ll) == 3);
     // Destroy linked list and report
     linked_list_destroy(ll, NULL);
@@ -200,11 +222,374 @@ void test_linked_list_delete() {
     // Delete from the back
     assert(linked_list_delete(ll, 1) == (int*)4);
     assert(linked_list_size(ll) == 1);
+    assert(linked_list_peek_back(ll) == (int*)3);
+    // Index equal to the size is out of range
+    assert(linked_list_delete(ll, 1) == NULL);
+    assert(linked_list_size(ll) == 1);
+    // Delete the only element, then check head and tail were reset
+    assert(linked_list_delete(ll, 0) == (int*)3);
+    assert(linked_list_peek_front(ll) == NULL);
+    assert(linked_list_peek_back(ll) == NULL);
+    // Destroy linked list and report
+    linked_list_destroy(ll, NULL);
+    print_test_passed(__func__);
+}
+
+void test_linked_list_drain_both_ends() {
+    // Create linked list
+    linked_list_t* ll = linked_list_create();
+    for (size_t i = 1; i <= 100; i++) {
+        linked_list_push_back(ll, (void*)i);
+    }
+    // Lookups walk from the closer end
+    assert(linked_list_lookup(ll, 10) == (void*)11);
+    assert(linked_list_lookup(ll, 90) == (void*)91);
+    // Insert and delete in the back half keep the links consistent
+    assert(linked_list_insert(ll, 98, (void*)1000) == true);
+    assert(linked_list_lookup(ll, 98) == (void*)1000);
+    assert(linked_list_lookup(ll, 99) == (void*)99);
+    assert(linked_list_delete(ll, 98) == (void*)1000);
+    // Alternate pops from both ends until the list is empty
+    for (size_t i = 1; i <= 50; i++) {
+        assert(linked_list_pop_front(ll) == (void*)i);
+        assert(linked_list_pop_back(ll) == (void*)(101 - i));
+    }
+    assert(linked_list_size(ll) == 0);
+    assert(linked_list_pop_back(ll) == NULL);
+    // The emptied list must be reusable from either end
+    linked_list_push_back(ll, (int*)1);
+    linked_list_push_front(ll, (int*)2);
+    assert(linked_list_peek_front(ll) == (int*)2);
+    assert(linked_list_peek_back(ll) == (int*)1);
+    assert(linked_list_pop_front(ll) == (int*)2);
+    assert(linked_list_pop_front(ll) == (int*)1);
+    linked_list_push_back(ll, (int*)3);
+    assert(linked_list_peek_front(ll) == (int*)3);
+    assert(linked_list_pop_back(ll) == (int*)3);
     // Destroy linked list and report
     linked_list_destroy(ll, NULL);
     print_test_passed(__func__);
 }
 
+void test_linked_list_pool() {
+    // Create two linked lists sharing a pool
+    linked_list_pool_t* pool = linked_list_pool_create();
+    assert(pool != NULL);
+    linked_list_t* a = linked_list_create_with_pool(pool);
+    linked_list_t* b = linked_list_create_with_pool(pool);
+    assert(a != NULL && b != NULL);
+    // Move elements from one list to the other so nodes get recycled
+    for (size_t i = 1; i <= 1000; i++) {
+        linked_list_push_back(a, (void*)i);
+    }
+    for (size_t i = 1; i <= 1000; i++) {
+        assert(linked_list_push_back(b, linked_list_pop_front(a)) == true);
+    }
+    assert(linked_list_size(a) == 0);
+    assert(linked_list_size(b) == 1000);
+    for (size_t i = 0; i < 1000; i++) {
+        assert(linked_list_lookup(b, i) == (void*)(i + 1));
+    }
+    // Destroy one list, the other one stays valid
+    linked_list_destroy(a, NULL);
+    assert(linked_list_insert(b, 500, (int*)1) == true);
+    assert(linked_list_delete(b, 500) == (int*)1);
+    assert(linked_list_pop_back(b) == (void*)1000);
+    // Destroy lists before the pool and report
+    linked_list_destroy(b, NULL);
+    linked_list_pool_destroy(pool);
+    print_test_passed(__func__);
+}
+
+void test_linked_list_cursor() {
+    // Create linked list
+    linked_list_t* ll = linked_list_create();
+    // Cursors on an empty list are past the end
+    linked_list_cursor_t cursor = linked_list_cursor_front(ll);
+    assert(linked_list_cursor_valid(&cursor) == false);
+    assert(linked_list_cursor_get(&cursor) == NULL);
+    assert(linked_list_cursor_remove(&cursor) == NULL);
+    assert(linked_list_cursor_insert_after(&cursor, (int*)1) == false);
+    // Inserting before the end appends
+    assert(linked_list_cursor_insert_before(&cursor, (int*)2) == true);
+    assert(linked_list_cursor_insert_before(&cursor, (int*)4) == true);
+    assert(linked_list_size(ll) == 2);
+    // Insert around an element
+    cursor = linked_list_cursor_front(ll);
+    assert(linked_list_cursor_get(&cursor) == (int*)2);
+    assert(linked_list_cursor_insert_before(&cursor, (int*)1) == true);
+    assert(linked_list_cursor_insert_after(&cursor, (int*)3) == true);
+    assert(linked_list_cursor_get(&cursor) == (int*)2);
+    // Walk forwards and backwards
+    cursor = linked_list_cursor_front(ll);
+    for (size_t i = 1; i <= 4; i++) {
+        assert(linked_list_cursor_get(&cursor) == (void*)i);
+        linked_list_cursor_next(&cursor);
+    }
+    assert(linked_list_cursor_valid(&cursor) == false);
+    linked_list_cursor_prev(&cursor);
+    assert(linked_list_cursor_get(&cursor) == (int*)4);
+    cursor = linked_list_cursor_back(ll);
+    for (size_t i = 4; i >= 1; i--) {
+        assert(linked_list_cursor_get(&cursor) == (void*)i);
+        linked_list_cursor_prev(&cursor);
+    }
+    assert(linked_list_cursor_valid(&cursor) == false);
+    // Removing the back element keeps the tail up to date
+    cursor = linked_list_cursor_back(ll);
+    assert(linked_list_cursor_remove(&cursor) == (int*)4);
+    assert(linked_list_cursor_valid(&cursor) == false);
+    assert(linked_list_peek_back(ll) == (int*)3);
+    // Removing the front element keeps the head up to date
+    cursor = linked_list_cursor_front(ll);
+    assert(linked_list_cursor_remove(&cursor) == (int*)1);
+    assert(linked_list_cursor_get(&cursor) == (int*)2);
+    assert(linked_list_peek_front(ll) == (int*)2);
+    assert(linked_list_size(ll) == 2);
+    // Destroy linked list and report
+    linked_list_destroy(ll, NULL);
+    print_test_passed(__func__);
+}
+
+void test_linked_list_cursor_filter() {
+    // Create linked list
+    linked_list_t* ll = linked_list_create();
+    for (size_t i = 1; i <= 1000; i++) {
+        linked_list_push_back(ll, (void*)i);
+    }
+    // Remove odd elements and duplicate multiples of ten in a single pass
+    linked_list_cursor_t cursor = linked_list_cursor_front(ll);
+    while (linked_list_cursor_valid(&cursor)) {
+        size_t value = (size_t)linked_list_cursor_get(&cursor);
+        if (value % 2 == 1) {
+            linked_list_cursor_remove(&cursor);
+            continue;
+        }
+        if (value % 10 == 0) {
+            linked_list_cursor_insert_before(&cursor, (void*)value);
+        }
+        linked_list_cursor_next(&cursor);
+    }
+    assert(linked_list_size(ll) == 600);
+    assert(linked_list_lookup(ll, 3) == (void*)8);
+    assert(linked_list_lookup(ll, 4) == (void*)10);
+    assert(linked_list_lookup(ll, 5) == (void*)10);
+    assert(linked_list_peek_back(ll) == (void*)1000);
+    // Destroy linked list and report
+    linked_list_destroy(ll, NULL);
+    print_test_passed(__func__);
+}
+
+static void sum_objects(void* obj, void* arg) { *(size_t*)arg += (size_t)obj; }
+
+void test_linked_list_foreach() {
+    // Create linked list
+    linked_list_t* ll = linked_list_create();
+    size_t sum = 0;
+    linked_list_foreach(ll, sum_objects, &sum);
+    assert(sum == 0);
+    for (size_t i = 1; i <= 100; i++) {
+        linked_list_push_back(ll, (void*)i);
+    }
+    // Visit every element
+    linked_list_foreach(ll, sum_objects, &sum);
+    assert(sum == 5050);
+    // Destroy linked list and report
+    linked_list_destroy(ll, NULL);
+    print_test_passed(__func__);
+}
+
+void test_linked_list_splice() {
+    // Splice two lists with private pools
+    linked_list_t* a = linked_list_create();
+    linked_list_t* b = linked_list_create();
+    assert(linked_list_splice(a, a) == false);
+    assert(linked_list_splice(a, b) == true);
+    assert(linked_list_size(a) == 0);
+    for (size_t i = 1; i <= 100; i++) {
+        linked_list_push_back(i <= 50 ? a : b, (void*)i);
+    }
+    assert(linked_list_splice(a, b) == true);
+    assert(linked_list_size(a) == 100);
+    assert(linked_list_size(b) == 0);
+    assert(linked_list_peek_back(a) == (void*)100);
+    assert(linked_list_pop_back(b) == NULL);
+    // Both lists stay usable, and spliced nodes can be freed by `a`
+    linked_list_push_back(b, (int*)1);
+    for (size_t i = 100; i >= 1; i--) {
+        assert(linked_list_pop_back(a) == (void*)i);
+    }
+    linked_list_destroy(b, NULL);
+    // Splice into an empty list from a shared pool
+    linked_list_pool_t* pool = linked_list_pool_create();
+    linked_list_t* c = linked_list_create_with_pool(pool);
+    linked_list_push_back(c, (int*)1);
+    linked_list_push_back(c, (int*)2);
+    assert(linked_list_splice(a, c) == true);
+    assert(linked_list_size(a) == 2 && linked_list_size(c) == 0);
+    assert(linked_list_peek_front(a) == (int*)1);
+    assert(linked_list_peek_back(a) == (int*)2);
+    linked_list_destroy(c, NULL);
+    linked_list_pool_destroy(pool);
+    // Destroy linked list and report
+    linked_list_destroy(a, NULL);
+    print_test_passed(__func__);
+}
+
+void test_linked_list_push_back_many() {
+    // Create linked list
+    linked_list_t* ll = linked_list_create();
+    void* objs[] = {(int*)1, (int*)2, (int*)3, NULL};
+    // Arrays containing NULL are rejected as a whole
+    assert(linked_list_push_back_many(ll, objs, 4) == false);
+    assert(linked_list_size(ll) == 0);
+    assert(linked_list_push_back_many(ll, objs, 0) == true);
+    // Add twice
+    assert(linked_list_push_back_many(ll, objs, 3) == true);
+    assert(linked_list_push_back_many(ll, objs, 3) == true);
+    assert(linked_list_size(ll) == 6);
+    for (size_t i = 0; i < 6; i++) {
+        assert(linked_list_lookup(ll, i) == (void*)(i % 3 + 1));
+    }
+    assert(linked_list_peek_back(ll) == (int*)3);
+    assert(linked_list_pop_back(ll) == (int*)3);
+    // Destroy linked list and report
+    linked_list_destroy(ll, NULL);
+    print_test_passed(__func__);
+}
+
+void test_linked_list_to_array() {
+    // Create linked list
+    linked_list_t* ll = linked_list_create();
+    assert(linked_list_to_array(ll) == NULL);
+    for (size_t i = 1; i <= 100; i++) {
+        linked_list_push_back(ll, (void*)i);
+    }
+    // The array holds the objects in order
+    void** array = linked_list_to_array(ll);
+    assert(array != NULL);
+    for (size_t i = 0; i < 100; i++) {
+        assert(array[i] == (void*)(i + 1));
+    }
+    free(array);
+    // Destroy linked list and report
+    linked_list_destroy(ll, NULL);
+    print_test_passed(__func__);
+}
+
+typedef struct {
+    unsigned int key;
+    size_t seq;
+} sort_item_t;
+
+static int compare_items(const void* a, const void* b) {
+    const sort_item_t* x = a;
+    const sort_item_t* y = b;
+    return (x->key > y->key) - (x->key < y->key);
+}
+
+// Checks that the list is ordered by key, that equal keys kept their
+// insertion order, and that walking back from the tail sees the same nodes
+static void check_sorted(linked_list_t* ll, size_t n) {
+    assert(linked_list_size(ll) == n);
+    void** array = linked_list_to_array(ll);
+    for (size_t i = 1; i < n; i++) {
+        const sort_item_t* prev = array[i - 1];
+        const sort_item_t* item = array[i];
+        assert(prev->key < item->key ||
+               (prev->key == item->key && prev->seq < item->seq));
+    }
+    linked_list_cursor_t cursor = linked_list_cursor_back(ll);
+    for (size_t i = n; i > 0; i--) {
+        assert(linked_list_cursor_get(&cursor) == array[i - 1]);
+        linked_list_cursor_prev(&cursor);
+    }
+    assert(linked_list_cursor_valid(&cursor) == false);
+    assert(n == 0 || linked_list_peek_back(ll) == array[n - 1]);
+    free(array);
+}
+
+static void check_sort(size_t n, size_t num_threads) {
+    linked_list_t* ll = linked_list_create();
+    sort_item_t* items = malloc((n + 1) * sizeof(*items));
+    unsigned int seed = 1;
+    for (size_t i = 0; i < n; i++) {
+        // Few distinct keys, so stability is exercised
+        seed = seed * 1103515245 + 12345;
+        items[i].key = (seed >> 8) % (n / 4 + 1);
+        items[i].seq = i;
+        linked_list_push_back(ll, &items[i]);
+    }
+    if (num_threads == 0) {
+        linked_list_sort(ll, compare_items);
+    } else {
+        linked_list_sort_parallel(ll, compare_items, num_threads);
+    }
+    check_sorted(ll, n);
+    // The tail is usable after sorting
+    items[n].key = 0;
+    linked_list_push_back(ll, &items[n]);
+    assert(linked_list_pop_back(ll) == &items[n]);
+    linked_list_destroy(ll, NULL);
+    free(items);
+}
+
+void test_linked_list_sort() {
+    linked_list_sort(NULL, compare_items);
+    size_t sizes[] = {0, 1, 2, 3, 17, 1000, 4096};
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        check_sort(sizes[i], 0);
+    }
+    print_test_passed(__func__);
+}
+
+void test_linked_list_sort_parallel() {
+    // Short lists fall back to the sequential sort
+    check_sort(1000, 4);
+    // Long enough to be split, with run counts that are not powers of two
+    check_sort(200000, 3);
+    check_sort(200000, 4);
+    check_sort(200000, 7);
+    print_test_passed(__func__);
+}
+
+void test_linked_list_allocator() {
+    counting_t counts_a = {0, 0};
+    counting_t counts_b = {0, 0};
+    allocator_t allocator_a = {counting_alloc, counting_free, &counts_a};
+    allocator_t allocator_b = {counting_alloc, counting_free, &counts_b};
+    linked_list_t* a1 = linked_list_create_with_allocator(&allocator_a);
+    linked_list_t* a2 = linked_list_create_with_allocator(&allocator_a);
+    linked_list_t* b = linked_list_create_with_allocator(&allocator_b);
+    assert(a1 != NULL && a2 != NULL && b != NULL);
+    for (size_t i = 1; i <= 10000; i++) {
+        linked_list_push_back(i % 2 ? a1 : a2, (void*)i);
+        linked_list_push_back(b, (void*)i);
+    }
+    size_t blocks_b = counts_b.live_blocks;
+    // Lists on the same allocator hand their chunks over
+    assert(linked_list_splice(a1, a2) == true);
+    // Nodes from another allocator are copied instead
+    assert(linked_list_splice(a1, b) == true);
+    assert(linked_list_size(a1) == 20000 && linked_list_size(b) == 0);
+    assert(counts_b.live_blocks == blocks_b);
+    linked_list_destroy(a2, NULL);
+    linked_list_destroy(b, NULL);
+    assert(counts_b.live_blocks == 0 && counts_b.live_bytes == 0);
+    linked_list_destroy(a1, NULL);
+    assert(counts_a.live_blocks == 0 && counts_a.live_bytes == 0);
+    // Lists on a shared pool are allocated through the pool's allocator
+    linked_list_pool_t* pool =
+        linked_list_pool_create_with_allocator(&allocator_a);
+    linked_list_t* ll = linked_list_create_with_pool(pool);
+    linked_list_push_back(ll, (int*)1);
+    assert(counts_a.live_blocks == 3);
+    linked_list_destroy(ll, NULL);
+    linked_list_pool_destroy(pool);
+    assert(counts_a.live_blocks == 0 && counts_a.live_bytes == 0);
+    print_test_passed(__func__);
+}
+
 int main(int argc, char** argv) {
     printf("Running tests in: %s\n", argv[0]);
     test_linked_list_create_destroy();
@@ -217,5 +602,16 @@ int main(int argc, char** argv) {
     test_linked_list_lookup();
     test_linked_list_insert();
     test_linked_list_delete();
+    test_linked_list_drain_both_ends();
+    test_linked_list_pool();
+    test_linked_list_cursor();
+    test_linked_list_cursor_filter();
+    test_linked_list_foreach();
+    test_linked_list_splice();
+    test_linked_list_push_back_many();
+    test_linked_list_to_array();
+    test_linked_list_sort();
+    test_linked_list_sort_parallel();
+    test_linked_list_allocator();
     return 0;
 }
@@ -0,0 +1,92 @@
+#include "spscring.h"
+#include <assert.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#define NUM_ITEMS 200000
+
+void print_test_passed(const char* test_name) {
+    printf("\t- %s: \033[1;32mPASSED\033[0m\n", test_name);
+}
+
+void test_spsc_ring_create_destroy() {
+    assert(spsc_ring_create(0) == NULL);
+    // Capacities whose slot array cannot be represented are rejected
+    assert(spsc_ring_create((size_t)1 << 62) == NULL);
+    assert(spsc_ring_create(SIZE_MAX) == NULL);
+    spsc_ring_t* ring = spsc_ring_create(10);
+    assert(ring != NULL);
+    assert(spsc_ring_pop(ring) == NULL);
+    spsc_ring_destroy(ring, NULL);
+    print_test_passed(__func__);
+}
+
+void test_spsc_ring_push_pop() {
+    // Capacity is rounded up to 4
+    spsc_ring_t* ring = spsc_ring_create(3);
+    assert(spsc_ring_push(ring, NULL) == false);
+    for (size_t i = 1; i <= 4; i++) {
+        assert(spsc_ring_push(ring, (void*)i) == true);
+    }
+    // Full ring rejects pushes
+    assert(spsc_ring_push(ring, (int*)5) == false);
+    assert(spsc_ring_pop(ring) == (int*)1);
+    assert(spsc_ring_push(ring, (int*)5) == true);
+    // Objects come out in order, across the wrap-around
+    for (size_t i = 2; i <= 5; i++) {
+        assert(spsc_ring_pop(ring) == (void*)i);
+    }
+    assert(spsc_ring_pop(ring) == NULL);
+    spsc_ring_destroy(ring, NULL);
+    print_test_passed(__func__);
+}
+
+void test_spsc_ring_destroy_free_func() {
+    spsc_ring_t* ring = spsc_ring_create(8);
+    for (size_t i = 0; i < 6; i++) {
+        spsc_ring_push(ring, malloc(16));
+    }
+    free(spsc_ring_pop(ring));
+    // Destroying with free() must not leak nor double free
+    spsc_ring_destroy(ring, free);
+    print_test_passed(__func__);
+}
+
+static void* producer(void* ptr) {
+    spsc_ring_t* ring = ptr;
+    for (size_t i = 1; i <= NUM_ITEMS; i++) {
+        while (!spsc_ring_push(ring, (void*)i)) {
+            sched_yield();
+        }
+    }
+    return NULL;
+}
+
+void test_spsc_ring_threads() {
+    // A small ring forces the producer to wait on the consumer
+    spsc_ring_t* ring = spsc_ring_create(16);
+    pthread_t thread;
+    pthread_create(&thread, NULL, producer, ring);
+    for (size_t i = 1; i <= NUM_ITEMS; i++) {
+        void* obj;
+        while ((obj = spsc_ring_pop(ring)) == NULL) {
+            sched_yield();
+        }
+        assert(obj == (void*)i);
+    }
+    pthread_join(thread, NULL);
+    assert(spsc_ring_pop(ring) == NULL);
+    spsc_ring_destroy(ring, NULL);
+    print_test_passed(__func__);
+}
+
+int main(int argc, char** argv) {
+    printf("Running tests in: %s\n", argv[0]);
+    test_spsc_ring_create_destroy();
+    test_spsc_ring_push_pop();
+    test_spsc_ring_destroy_free_func();
+    test_spsc_ring_threads();
+    return 0;
+}
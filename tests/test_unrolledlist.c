@@ -0,0 +1,142 @@
+#include "unrolledlist.h"
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+
+void print_test_passed(const char* test_name) {
+    printf("\t- %s: \033[1;32mPASSED\033[0m\n", test_name);
+}
+
+void test_unrolled_list_create_destroy() {
+    // Create list
+    unrolled_list_t* ul = unrolled_list_create();
+    assert(ul != NULL);
+    assert(unrolled_list_size(ul) == 0);
+    // Destroy list
+    unrolled_list_destroy(ul, NULL);
+    // Report
+    print_test_passed(__func__);
+}
+
+void test_unrolled_list_push_pop() {
+    // Create list
+    unrolled_list_t* ul = unrolled_list_create();
+    // Empty list
+    assert(unrolled_list_peek_front(ul) == NULL);
+    assert(unrolled_list_peek_back(ul) == NULL);
+    assert(unrolled_list_pop_front(ul) == NULL);
+    assert(unrolled_list_pop_back(ul) == NULL);
+    // Try pushing NULL
+    assert(unrolled_list_push_front(ul, NULL) == false);
+    assert(unrolled_list_push_back(ul, NULL) == false);
+    // Push enough elements on both ends to span several nodes
+    for (size_t i = 1; i <= 100; i++) {
+        assert(unrolled_list_push_back(ul, (void*)(100 + i)) == true);
+        assert(unrolled_list_push_front(ul, (void*)(101 - i)) == true);
+    }
+    assert(unrolled_list_size(ul) == 200);
+    assert(unrolled_list_peek_front(ul) == (void*)1);
+    assert(unrolled_list_peek_back(ul) == (void*)200);
+    // Pop from both ends
+    for (size_t i = 1; i <= 100; i++) {
+        assert(unrolled_list_pop_front(ul) == (void*)i);
+        assert(unrolled_list_pop_back(ul) == (void*)(201 - i));
+    }
+    assert(unrolled_list_size(ul) == 0);
+    assert(unrolled_list_peek_front(ul) == NULL);
+    assert(unrolled_list_peek_back(ul) == NULL);
+    // The emptied list is reusable
+    assert(unrolled_list_push_back(ul, "value") == true);
+    assert(strcmp(unrolled_list_peek_front(ul), "value") == 0);
+    // Destroy list and report
+    unrolled_list_destroy(ul, NULL);
+    print_test_passed(__func__);
+}
+
+void test_unrolled_list_insert_delete() {
+    // Create list
+    unrolled_list_t* ul = unrolled_list_create();
+    // Insert invalid
+    assert(unrolled_list_insert(ul, 1, (int*)1) == false);
+    assert(unrolled_list_delete(ul, 0) == NULL);
+    // Insert at the front, back and within
+    assert(unrolled_list_insert(ul, 0, (int*)2) == true);
+    assert(unrolled_list_insert(ul, 0, (int*)1) == true);
+    assert(unrolled_list_insert(ul, 2, (int*)4) == true);
+    assert(unrolled_list_insert(ul, 2, (int*)3) == true);
+    for (size_t i = 0; i < 4; i++) {
+        assert(unrolled_list_lookup(ul, i) == (void*)(i + 1));
+    }
+    assert(unrolled_list_lookup(ul, 4) == NULL);
+    // Delete invalid
+    assert(unrolled_list_delete(ul, 4) == NULL);
+    assert(unrolled_list_size(ul) == 4);
+    // Delete from within, the front and the back
+    assert(unrolled_list_delete(ul, 1) == (int*)2);
+    assert(unrolled_list_delete(ul, 0) == (int*)1);
+    assert(unrolled_list_delete(ul, 1) == (int*)4);
+    assert(unrolled_list_size(ul) == 1);
+    assert(unrolled_list_peek_front(ul) == (int*)3);
+    assert(unrolled_list_peek_back(ul) == (int*)3);
+    // Destroy list and report
+    unrolled_list_destroy(ul, NULL);
+    print_test_passed(__func__);
+}
+
+void test_unrolled_list_random() {
+    // Apply random inserts and deletes to the list and to a plain array, so
+    // that node splits and merges are checked against a reference
+    enum { MAX_ELEMENTS = 2000, NUM_OPS = 20000 };
+    unrolled_list_t* ul = unrolled_list_create();
+    void** ref = malloc(MAX_ELEMENTS * sizeof(*ref));
+    size_t size = 0;
+    unsigned int seed = 1;
+    for (size_t op = 0; op < NUM_OPS; op++) {
+        seed = seed * 1103515245 + 12345;
+        size_t r = seed >> 8;
+        if (size < MAX_ELEMENTS && (size == 0 || r % 3 != 0)) {
+            size_t index = r % (size + 1);
+            void* obj = (void*)(op + 1);
+            assert(unrolled_list_insert(ul, index, obj) == true);
+            memmove(&ref[index + 1], &ref[index],
+                    (size - index) * sizeof(*ref));
+            ref[index] = obj;
+            size++;
+        } else {
+            size_t index = r % size;
+            assert(unrolled_list_delete(ul, index) == ref[index]);
+            memmove(&ref[index], &ref[index + 1],
+                    (size - index - 1) * sizeof(*ref));
+            size--;
+        }
+        assert(unrolled_list_size(ul) == size);
+    }
+    for (size_t i = 0; i < size; i++) {
+        assert(unrolled_list_lookup(ul, i) == ref[i]);
+    }
+    // Destroy list and report
+    free(ref);
+    unrolled_list_destroy(ul, NULL);
+    print_test_passed(__func__);
+}
+
+void test_unrolled_list_destroy_free_func() {
+    // Create list of heap-allocated objects
+    unrolled_list_t* ul = unrolled_list_create();
+    for (size_t i = 0; i < 50; i++) {
+        unrolled_list_push_back(ul, malloc(16));
+    }
+    // Destroying with free() must not leak
+    unrolled_list_destroy(ul, free);
+    print_test_passed(__func__);
+}
+
+int main(int argc, char** argv) {
+    printf("Running tests in: %s\n", argv[0]);
+    test_unrolled_list_create_destroy();
+    test_unrolled_list_push_pop();
+    test_unrolled_list_insert_delete();
+    test_unrolled_list_random();
+    test_unrolled_list_destroy_free_func();
+    return 0;
+}
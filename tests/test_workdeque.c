@@ -0,0 +1,142 @@
+#include "workdeque.h"
+#include <assert.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#define NUM_THIEVES 4
+#define NUM_ITEMS 100000
+
+void print_test_passed(const char* test_name) {
+    printf("\t- %s: \033[1;32mPASSED\033[0m\n", test_name);
+}
+
+void test_work_deque_create_destroy() {
+    work_deque_t* dq = work_deque_create(0);
+    assert(dq != NULL);
+    assert(work_deque_pop(dq) == NULL);
+    assert(work_deque_steal(dq) == NULL);
+    work_deque_destroy(dq);
+    // Capacities whose buffer cannot be represented are rejected
+    assert(work_deque_create((size_t)1 << 62) == NULL);
+    assert(work_deque_create(SIZE_MAX) == NULL);
+    print_test_passed(__func__);
+}
+
+void test_work_deque_push_pop() {
+    work_deque_t* dq = work_deque_create(4);
+    assert(work_deque_push(dq, NULL) == false);
+    // The owner pops in LIFO order, growing past the initial capacity
+    for (size_t i = 1; i <= 100; i++) {
+        assert(work_deque_push(dq, (void*)i) == true);
+    }
+    for (size_t i = 100; i >= 1; i--) {
+        assert(work_deque_pop(dq) == (void*)i);
+    }
+    assert(work_deque_pop(dq) == NULL);
+    // The emptied deque is reusable
+    assert(work_deque_push(dq, (int*)1) == true);
+    assert(work_deque_pop(dq) == (int*)1);
+    work_deque_destroy(dq);
+    print_test_passed(__func__);
+}
+
+void test_work_deque_steal() {
+    work_deque_t* dq = work_deque_create(4);
+    for (size_t i = 1; i <= 100; i++) {
+        work_deque_push(dq, (void*)i);
+    }
+    // Thieves take the oldest objects, the owner the newest
+    for (size_t i = 1; i <= 50; i++) {
+        assert(work_deque_steal(dq) == (void*)i);
+    }
+    assert(work_deque_pop(dq) == (void*)100);
+    // Wrap around the circular buffer while it holds 51 to 99
+    for (size_t i = 101; i <= 200; i++) {
+        work_deque_push(dq, (void*)i);
+        assert(work_deque_steal(dq) == (void*)(i < 150 ? i - 50 : i - 49));
+    }
+    for (size_t i = 200; i > 151; i--) {
+        assert(work_deque_pop(dq) == (void*)i);
+    }
+    assert(work_deque_steal(dq) == NULL);
+    work_deque_destroy(dq);
+    print_test_passed(__func__);
+}
+
+typedef struct {
+    work_deque_t* dq;
+    _Atomic size_t* taken;
+    _Atomic unsigned char* seen;
+} thief_args_t;
+
+static void take(thief_args_t* args, size_t item) {
+    assert(item >= 1 && item <= NUM_ITEMS);
+    unsigned char times = atomic_fetch_add(&args->seen[item - 1], 1);
+    assert(times == 0);
+    (*args->taken)++;
+}
+
+static void* thief(void* ptr) {
+    thief_args_t* args = ptr;
+    size_t last = 0;
+    while (*args->taken < NUM_ITEMS) {
+        size_t item = (size_t)work_deque_steal(args->dq);
+        if (item == 0) {
+            sched_yield();
+            continue;
+        }
+        // One thief sees objects in the order they were pushed
+        assert(item > last);
+        last = item;
+        take(args, item);
+    }
+    return NULL;
+}
+
+// The owner pushes every object and pops some back while thieves steal from
+// the other end. Every object must be taken exactly once.
+void test_work_deque_threads() {
+    work_deque_t* dq = work_deque_create(2);
+    _Atomic size_t taken = 0;
+    _Atomic unsigned char* seen = calloc(NUM_ITEMS, 1);
+    thief_args_t args = {dq, &taken, seen};
+    pthread_t threads[NUM_THIEVES];
+    for (size_t t = 0; t < NUM_THIEVES; t++) {
+        pthread_create(&threads[t], NULL, thief, &args);
+    }
+    for (size_t i = 1; i <= NUM_ITEMS; i++) {
+        assert(work_deque_push(dq, (void*)i) == true);
+        if (i % 3 == 0) {
+            size_t item = (size_t)work_deque_pop(dq);
+            if (item != 0) {
+                take(&args, item);
+            }
+        }
+    }
+    size_t item;
+    while ((item = (size_t)work_deque_pop(dq)) != 0) {
+        take(&args, item);
+    }
+    for (size_t t = 0; t < NUM_THIEVES; t++) {
+        pthread_join(threads[t], NULL);
+    }
+    assert(taken == NUM_ITEMS);
+    for (size_t i = 0; i < NUM_ITEMS; i++) {
+        assert(seen[i] == 1);
+    }
+    free((void*)seen);
+    work_deque_destroy(dq);
+    print_test_passed(__func__);
+}
+
+int main(int argc, char** argv) {
+    printf("Running tests in: %s\n", argv[0]);
+    test_work_deque_create_destroy();
+    test_work_deque_push_pop();
+    test_work_deque_steal();
+    test_work_deque_threads();
+    return 0;
+}